@@ -0,0 +1,313 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gecode/search.hh>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "nmbr9/lib.h"
+#include "nmbr9/anchor.h"
+#include "nmbr9/batch.h"
+
+using namespace Gecode;
+
+namespace {
+
+    /// One entry in the benchmark matrix
+    struct BenchCase {
+        /// Unique name of the case, used to match it with the baseline
+        std::string name;
+        /// The options for the case, as on the command line
+        std::string options;
+    };
+
+    /// The measurements for one case
+    struct BenchResult {
+        std::string name;
+        std::string options;
+        int score;
+        bool complete;
+        double runtime;
+        unsigned long int nodes;
+        unsigned long int failures;
+        long memory;
+    };
+
+    /**
+     * The fixed matrix of cases: the instance from the paper with 6 values, 2 copies, 5 cards, an 8x8 grid and 3
+     * layers for both models and with 1 and 4 threads, and with translation symmetry breaking, and sweeps over the
+     * deck size, the grid size, and the number of layers from that instance.
+     */
+    std::vector<BenchCase> benchmark_cases() {
+        const auto instance = [](int deck, int grid, int layers) {
+            std::ostringstream os;
+            os << "-max-value 6 -copies 2 -deck-size " << deck << " -grid-size " << grid << " -max-layers " << layers;
+            return os.str();
+        };
+
+        std::vector<BenchCase> cases;
+        for (const std::string model : {"board", "anchor"}) {
+            for (int threads : {1, 4}) {
+                cases.push_back({"paper-" + model + "-t" + std::to_string(threads),
+                                 instance(5, 8, 3) + " -model " + model + " -threads " + std::to_string(threads)});
+            }
+        }
+        cases.push_back({"paper-board-translation", instance(5, 8, 3) + " -translation-symmetry true"});
+        for (int deck = 3; deck <= 7; ++deck) {
+            cases.push_back({"deck-" + std::to_string(deck), instance(deck, 8, 3)});
+        }
+        for (int grid = 6; grid <= 10; ++grid) {
+            cases.push_back({"grid-" + std::to_string(grid), instance(5, grid, 3)});
+        }
+        for (int layers = 2; layers <= 5; ++layers) {
+            cases.push_back({"layers-" + std::to_string(layers), instance(5, 8, layers)});
+        }
+        return cases;
+    }
+
+    /// Search for the best layout with branch and bound, with the threads and the time limit in the options
+    template<class Model>
+    BenchResult run_case(const nmbr9::Nmbr9Options& opt) {
+        const auto start = std::chrono::steady_clock::now();
+        auto* model = new Model(opt);
+
+        Search::Options so;
+        so.threads = opt.threads();
+        std::unique_ptr<Search::Stop> stop;
+        if (opt.time() > 0) {
+            stop = std::make_unique<Search::TimeStop>(opt.time());
+            so.stop = stop.get();
+        }
+        BAB<Model> engine(model, so);
+        delete model;
+
+        int best_score = -1;
+        while (Model* solution = engine.next()) {
+            best_score = solution->cost().val();
+            delete solution;
+        }
+        const std::chrono::duration<double, std::milli> runtime = std::chrono::steady_clock::now() - start;
+        const Search::Statistics statistics = engine.statistics();
+        return {"", "", best_score, !engine.stopped(), runtime.count(), statistics.node, statistics.fail, 0};
+    }
+
+    /**
+     * Run a case in a child process and measure the peak memory of the child.
+     *
+     * The peak memory of a process is its high-water mark, so measured in the benchmark itself it would be the
+     * largest of all the cases run so far. The child writes its result to a pipe and exits.
+     *
+     * @return False if the child could not be run or did not report a result
+     */
+    bool run_isolated(const nmbr9::Nmbr9Options& opt, BenchResult& result) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            return false;
+        }
+        const pid_t pid = fork();
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            return false;
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            const BenchResult child = opt.model() == nmbr9::MT_ANCHOR
+                                      ? run_case<nmbr9::Nmbr9AnchorBoard>(opt)
+                                      : run_case<nmbr9::Nmbr9Board>(opt);
+            std::ostringstream os;
+            os << child.score << " " << child.complete << " " << child.runtime << " " << child.nodes << " "
+               << child.failures;
+            const std::string text = os.str();
+            const bool written = write(fds[1], text.data(), text.size()) == static_cast<ssize_t>(text.size());
+            close(fds[1]);
+            _exit(written ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+
+        close(fds[1]);
+        std::string text;
+        char buffer[256];
+        ssize_t n;
+        while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+            text.append(buffer, static_cast<size_t>(n));
+        }
+        close(fds[0]);
+
+        int status = 0;
+        rusage usage{};
+        if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            return false;
+        }
+        std::istringstream is(text);
+        if (!(is >> result.score >> result.complete >> result.runtime >> result.nodes >> result.failures)) {
+            return false;
+        }
+#ifdef __APPLE__
+        // In bytes on macOS, in kilobytes elsewhere
+        result.memory = usage.ru_maxrss / 1024;
+#else
+        result.memory = usage.ru_maxrss;
+#endif
+        return true;
+    }
+
+    const char* const csv_header = "case,options,score,complete,runtime_ms,nodes,failures,peak_memory_kb";
+
+    std::ostream& operator<<(std::ostream& os, const BenchResult& result) {
+        return os << result.name << "," << result.options << "," << result.score << ","
+                  << (result.complete ? 1 : 0) << "," << result.runtime << "," << result.nodes << ","
+                  << result.failures << "," << result.memory;
+    }
+
+    /// Read the results in a CSV file written by the benchmark, by case name
+    bool read_baseline(const std::string& file, std::map<std::string, BenchResult>& baseline) {
+        std::ifstream is(file);
+        if (!is) {
+            return false;
+        }
+        std::string line;
+        std::getline(is, line);
+        while (std::getline(is, line)) {
+            std::istringstream fields(line);
+            BenchResult result{};
+            std::string field;
+            std::getline(fields, result.name, ',');
+            std::getline(fields, result.options, ',');
+            std::getline(fields, field, ',');
+            result.score = std::stoi(field);
+            std::getline(fields, field, ',');
+            result.complete = field == "1";
+            std::getline(fields, field, ',');
+            result.runtime = std::stod(field);
+            std::getline(fields, field, ',');
+            result.nodes = std::stoul(field);
+            std::getline(fields, field, ',');
+            result.failures = std::stoul(field);
+            std::getline(fields, field, ',');
+            result.memory = std::stol(field);
+            baseline[result.name] = result;
+        }
+        return true;
+    }
+
+    /**
+     * Compare a result with its baseline, and report the regressions.
+     *
+     * A different score is a regression when both searches were complete. The nodes are only compared for
+     * complete single-threaded searches, since parallel search is not deterministic. The runtime is a regression
+     * when it is larger by more than the tolerance and by more than 50 ms, to not report noise in short runs.
+     *
+     * @return The number of regressions
+     */
+    int compare(const BenchResult& result, const BenchResult& base, const double tolerance,
+                const bool deterministic) {
+        int regressions = 0;
+        const auto report = [&](const std::string& what, double value, double base_value) {
+            std::cout << "REGRESSION " << result.name << ": " << what << " " << value
+                      << " against " << base_value << " in the baseline" << std::endl;
+            ++regressions;
+        };
+        if (result.complete && base.complete && result.score != base.score) {
+            report("score", result.score, base.score);
+        }
+        if (base.complete && !result.complete) {
+            report("complete", 0, 1);
+        }
+        if (deterministic && result.complete && base.complete && result.nodes > base.nodes * (1 + tolerance)) {
+            report("nodes", result.nodes, base.nodes);
+        }
+        if (result.runtime > base.runtime * (1 + tolerance) && result.runtime - base.runtime > 50) {
+            report("runtime_ms", result.runtime, base.runtime);
+        }
+        if (result.memory > base.memory * (1 + tolerance)) {
+            report("peak_memory_kb", result.memory, base.memory);
+        }
+        return regressions;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::string out_file, baseline_file, filter;
+    double tolerance = 0.25;
+    unsigned int time = 60000;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "-out") {
+            out_file = argv[++i];
+        } else if (i + 1 < argc && arg == "-baseline") {
+            baseline_file = argv[++i];
+        } else if (i + 1 < argc && arg == "-tolerance") {
+            tolerance = std::stod(argv[++i]);
+        } else if (i + 1 < argc && arg == "-time") {
+            time = static_cast<unsigned int>(std::stoul(argv[++i]));
+        } else if (i + 1 < argc && arg == "-filter") {
+            filter = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [-out file] [-baseline file] [-tolerance fraction] [-time ms] [-filter text]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::map<std::string, BenchResult> baseline;
+    if (!baseline_file.empty() && !read_baseline(baseline_file, baseline)) {
+        std::cerr << "Could not read the baseline " << baseline_file << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<BenchResult> results;
+    int regressions = 0;
+    std::cout << csv_header << std::endl;
+    for (const BenchCase& bench_case : benchmark_cases()) {
+        if (bench_case.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        nmbr9::Nmbr9Options opt;
+        std::string error;
+        if (!nmbr9::parse_options(bench_case.options + " -time " + std::to_string(time), opt, error)) {
+            std::cerr << "Bad options for " << bench_case.name << ": " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        BenchResult result{};
+        if (!run_isolated(opt, result)) {
+            std::cerr << "Could not run " << bench_case.name << std::endl;
+            return EXIT_FAILURE;
+        }
+        result.name = bench_case.name;
+        result.options = bench_case.options;
+        std::cout << result << std::endl;
+        results.push_back(result);
+
+        const auto base = baseline.find(result.name);
+        if (base != baseline.end()) {
+            regressions += compare(result, base->second, tolerance, opt.threads() == 1);
+        }
+    }
+
+    if (!out_file.empty()) {
+        std::ofstream os(out_file);
+        os << csv_header << std::endl;
+        for (const BenchResult& result : results) {
+            os << result << std::endl;
+        }
+    }
+    if (!baseline_file.empty()) {
+        std::cout << regressions << " regressions against " << baseline_file << std::endl;
+    }
+
+    return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
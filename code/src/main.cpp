@@ -14,6 +14,11 @@
 
 #include "config.h"
 #include "nmbr9/lib.h"
+#include "nmbr9/anchor.h"
+#include "nmbr9/engines.h"
+#include "nmbr9/stream.h"
+#include "nmbr9/batch.h"
+#include "nmbr9/output.h"
 
 int main(int argc, char **argv) {
     // Clock function used.
@@ -23,10 +28,47 @@ int main(int argc, char **argv) {
 
     nmbr9::Nmbr9Options opt;
     opt.parse(argc,argv);
-    Gecode::Script::run<
-            nmbr9::Nmbr9Board,
-            Gecode::BAB,
-            nmbr9::Nmbr9Options>(opt);
+    switch (opt.engine()) {
+        case nmbr9::ET_SCRIPT:
+            switch (opt.model()) {
+                case nmbr9::MT_BOARD:
+                    if (opt.output() == nmbr9::OF_JSONL) {
+                        // Only JSON on the output, so no summary at the end
+                        nmbr9::run_jsonl<nmbr9::Nmbr9Board>(opt);
+                        return EXIT_SUCCESS;
+                    }
+                    Gecode::Script::run<
+                            nmbr9::Nmbr9Board,
+                            Gecode::BAB,
+                            nmbr9::Nmbr9Options>(opt);
+                    break;
+                case nmbr9::MT_ANCHOR:
+                    if (opt.output() == nmbr9::OF_JSONL) {
+                        nmbr9::run_jsonl<nmbr9::Nmbr9AnchorBoard>(opt);
+                        return EXIT_SUCCESS;
+                    }
+                    Gecode::Script::run<
+                            nmbr9::Nmbr9AnchorBoard,
+                            Gecode::BAB,
+                            nmbr9::Nmbr9Options>(opt);
+                    break;
+            }
+            break;
+        case nmbr9::ET_VERIFY:
+            return nmbr9::run_verify(opt) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        case nmbr9::ET_AUTO_GRID:
+            nmbr9::run_auto_grid(opt);
+            break;
+        case nmbr9::ET_DEEPENING:
+            nmbr9::run_deepening(opt);
+            break;
+        case nmbr9::ET_STREAM:
+            return nmbr9::run_stream(opt) >= 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        case nmbr9::ET_EVALUATE:
+            return nmbr9::run_evaluate(opt) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        case nmbr9::ET_BATCH:
+            return nmbr9::run_batch(opt) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
 
     // Report results
@@ -0,0 +1,309 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "anchor.h"
+#include "anchoring.h"
+#include "common.h"
+#include "stacking.h"
+#include "tiles.h"
+
+#include <gecode/driver.hh>
+#include <gecode/int.hh>
+#include <gecode/minimodel.hh>
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    //
+    // Main code setting up the model.
+    //
+
+    Nmbr9AnchorBoard::Nmbr9AnchorBoard(const Nmbr9Options& options)
+            : IntMaximizeScript(options),
+              instance_(options.instance()),
+              wh_(options.grid_size()),
+              nlevels_(options.max_layers()),
+              nparts_(options.number_of_parts()),
+              ncards_(options.deck_size()),
+              nsquares_(wh_ * wh_),
+              boards_(), // Initialized in body
+              tile_is_used_(*this, nparts_, 0, 1),
+              tile_is_on_level_(*this, nparts_*nlevels_, 0, 1),
+              tile_value_(nparts_), // Initialized in body
+              tile_level_(*this, nparts_, 0, nlevels_),
+              anchor_(*this, nparts_), // Initialized in body
+              x_(*this, nparts_, 0, wh_ - 1),
+              y_(*this, nparts_, 0, wh_ - 1),
+              orientation_(*this, nparts_, 0, 3),
+              deck_(*this, ncards_, 0, nparts_),
+              order_(*this, nparts_, 0, nparts_),
+              score_(*this, 0, options.max_value() * options.copies() * options.max_layers())
+    {
+        // Initialization of variables
+        //
+
+        boards_.reserve(nlevels_);
+        for (int l = 0; l < nlevels_; ++l) {
+            boards_.emplace_back(IntVarArray(*this, nsquares_, 0, nparts_));
+        }
+        std::vector<const FootprintTable*> part_footprints;
+        for (int p = 0; p < nparts_; ++p) {
+            tile_value_[p] = nmbr9::tile_value(instance_, p+1);
+            part_footprints.emplace_back(&nmbr9::footprints(instance_, p+1));
+            const int nfootprints = part_footprints.back()->size();
+            anchor_[p] = IntVar(*this, 0, std::max(nfootprints - 1, 0));
+        }
+
+
+        // Setting upp access to variables
+        //
+
+        Matrix<BoolVarArray> mtile_is_on_level(tile_is_on_level_, nparts_, nlevels_);
+
+
+        // Constraints. Numbers are with reference to the constraints in
+        // "Nmbr9 as a Constraint Programming Challenge"
+        //
+
+        // Outer columns and rows must be all zeroes, implied by the footprints
+        for (int l = 0; l < nlevels_; ++l) {
+            Matrix mboard(boards_[l], wh_, wh_);
+            IntVarArgs first_column = mboard.col(0);
+            IntVarArgs final_column = mboard.col(wh_-1);
+            IntVarArgs first_row = mboard.row(0);
+            IntVarArgs final_row = mboard.row(wh_-1);
+            for (int i = 0; i < wh_; ++i) {
+                rel(*this, first_column[i], IRT_EQ, 0);
+                rel(*this, final_column[i], IRT_EQ, 0);
+                rel(*this, first_row[i], IRT_EQ, 0);
+                rel(*this, final_row[i], IRT_EQ, 0);
+            }
+        }
+
+
+        // Deck is a shuffle and placements of parts
+        //
+
+        // (1) Deck is a shuffle
+        IntVarArgs tile_is_used_as_int;
+        for (int p = 0; p < nparts_; ++p) {
+            tile_is_used_as_int << channel(*this, tile_is_used_[p]);
+        }
+        count(*this, deck_, tile_is_used_as_int, options.ipl());
+
+        // (2) Placement constraints, using the anchors into the footprints
+        for (int p = 0; p < nparts_; ++p) {
+            const FootprintTable& footprints = *part_footprints[p];
+            anchored_placement(*this, boards_, tile_level_[p], anchor_[p], p, footprints);
+
+            if (footprints.empty()) {
+                rel(*this, tile_is_used_[p], IRT_EQ, 0);
+                rel(*this, x_[p], IRT_EQ, 0);
+                rel(*this, y_[p], IRT_EQ, 0);
+                rel(*this, orientation_[p], IRT_EQ, 0);
+                continue;
+            }
+
+            IntArgs xs, ys, orientations;
+            for (const Footprint& footprint : footprints) {
+                xs << footprint.x;
+                ys << footprint.y;
+                orientations << footprint.orientation;
+            }
+            element(*this, xs, anchor_[p], x_[p]);
+            element(*this, ys, anchor_[p], y_[p]);
+            element(*this, orientations, anchor_[p], orientation_[p]);
+
+            // Unused parts have a fixed anchor, so that they do not give rise to different solutions
+            rel(*this, !tile_is_used_[p] >> (anchor_[p] == 0));
+        }
+
+
+        // Basic channeling constraints
+        //
+
+        // (3) Deck to order
+        IntVarArgs extended_deck;
+        extended_deck << deck_;
+        while (extended_deck.size() < nparts_) {
+            extended_deck << IntVar(*this, 0, nparts_);
+        }
+        channel(*this, order_, extended_deck, options.ipl());
+
+        // (4) Order to is placed
+        for (int p = 0; p < nparts_; ++p) {
+            rel(*this, order_[p], IRT_LE, ncards_, Reify(tile_is_used_[p]));
+        }
+
+        // (5, 6) Level to is on is on level
+        for (int p = 0; p < nparts_; ++p) {
+            BoolVarArgs no_and_levels;
+            no_and_levels << expr(*this, !tile_is_used_[p]);
+            no_and_levels << mtile_is_on_level.col(p);
+            channel(*this, no_and_levels, tile_level_[p]);
+        }
+
+
+        // On-top and connectedness constraints
+        //
+
+        // (9) Connectedness constraints
+        for (int l = 0; l < nlevels_; ++l) {
+            anchored_connected(*this, boards_[l], order_, mtile_is_on_level.row(l), anchor_, part_footprints);
+        }
+
+        // (10, 11) On top requirements
+        for (int l = 1; l < nlevels_; ++l) {
+            stacking(*this, boards_[l], boards_[l-1], order_, mtile_is_on_level.row(l));
+        }
+
+
+        // Implied constraints
+        //
+
+        implied_levels(*this, instance_, boards_, tile_is_on_level_, deck_, tile_level_);
+
+
+        // Symmetry breaking constraints
+        //
+
+        break_symmetries(*this, options, boards_[0], deck_, tile_level_);
+
+
+        // Calculate the score of the solution
+        //
+
+        // (12) Score summation
+        IntVarArgs tile_score_levels;
+        for (int p = 0; p < nparts_; ++p) {
+            tile_score_levels << expr(*this, tile_level_[p] - tile_is_used_as_int[p]);
+        }
+        linear(*this, tile_value_, tile_score_levels, IRT_EQ, score_);
+
+        // Upper bound on the score from the levels the parts can still reach
+        bound_score(*this, options, tile_level_, score_);
+
+
+        // Set up heuristics
+        //
+
+        if (options.play_type() == PT_KNOWN) {
+            // A known deck is simulated by a random assignment.
+            // Adjust the seed parameter to get different instances.
+            assign(*this, deck_, INT_ASSIGN_RND(Rnd(options.seed())));
+        }
+
+        // First, decide the cards and their order in the deck
+        branch(*this, deck_, INT_VAR_NONE(), INT_VAL_MIN());
+
+        // Then, decide the level for the different cards.
+        // This uniquely determines the score.
+        branch(*this, tile_level_, INT_VAR_NONE(), INT_VAL_MAX());
+
+        // Place the parts in deck order. The footprints are ordered by the distance to the center,
+        // so the smallest anchor is the most central placement.
+        branch(*this, anchor_,
+               INT_VAR_MERIT_MIN([](const Space& home, IntVar x, int i) {
+                   return static_cast<double>(static_cast<const Nmbr9AnchorBoard&>(home).order_[i].min());
+               }),
+               INT_VAL_MIN());
+
+        // Assign the order variables (is the deck does not contain all parts,
+        // some are left undetermined by above branchings).
+        assign(*this, order_, INT_ASSIGN_MIN());
+    }
+
+
+    Nmbr9AnchorBoard::Nmbr9AnchorBoard(Nmbr9AnchorBoard &s) :
+            IntMaximizeScript(s), instance_(s.instance_), wh_(s.wh_), nlevels_(s.nlevels_),
+            nparts_(s.nparts_), ncards_(s.ncards_), nsquares_(s.nsquares_),
+            boards_(nlevels_, IntVarArray()),
+            tile_value_(s.tile_value_)
+    {
+        for (int l = 0; l < nlevels_; ++l) {
+            boards_[l].update(*this, s.boards_[l]);
+        }
+
+        tile_is_used_.update(*this, s.tile_is_used_);
+        tile_is_on_level_.update(*this, s.tile_is_on_level_);
+        tile_level_.update(*this, s.tile_level_);
+        anchor_.update(*this, s.anchor_);
+        x_.update(*this, s.x_);
+        y_.update(*this, s.y_);
+        orientation_.update(*this, s.orientation_);
+        deck_.update(*this, s.deck_);
+        order_.update(*this, s.order_);
+        score_.update(*this, s.score_);
+    }
+
+    Nmbr9AnchorBoard *Nmbr9AnchorBoard::copy() {
+        return new Nmbr9AnchorBoard(*this);
+    }
+
+    void Nmbr9AnchorBoard::print(std::ostream &os) const {
+        for (int l = 0; l < nlevels_; ++l) {
+            os << "Level " << l << std::endl;
+            for (int h = 0; h < wh_; ++h) {
+                os << "\t";
+                for (int w = 0; w < wh_; ++w) {
+                    print_square(os, boards_[l][h * wh_ + w]);
+                }
+                os << std::endl;
+            }
+            os << std::endl;
+        }
+        os << "Deck used :  {";
+        for (int i = 0; i < deck_.size(); ++i) {
+            os << std::setw(2) << deck_[i];
+            if (i < deck_.size()-1) {
+                os << ", ";
+            }
+        }
+        os << "}" << std::endl;
+        os << "Part values: {";
+        for (int i = 0; i < deck_.size(); ++i) {
+            if (deck_[i].assigned()) {
+                os << std::setw(2) << nmbr9::tile_value(instance_, deck_[i].val()+1);
+            } else {
+                os << " ?";
+            }
+            if (i < deck_.size()-1) {
+                os << ", ";
+            }
+        }
+        os << "}" << std::endl;
+        os << "Order of parts: " << order_ << std::endl;
+        os << "Tiles used : " << tile_is_used_ << std::endl;
+        os << "Tiles levels : " << tile_level_ << std::endl;
+        os << "Tiles columns : " << x_ << std::endl;
+        os << "Tiles rows : " << y_ << std::endl;
+        os << "Tiles orientations : " << orientation_ << std::endl;
+        os << "Score : " << score_ << std::endl;
+        if (deck_.assigned() && tile_level_.assigned() && x_.assigned() && y_.assigned() && orientation_.assigned()) {
+            os << "Layout : " << layout() << std::endl;
+        }
+    }
+
+    IntVar Nmbr9AnchorBoard::cost() const {
+        return score_;
+    }
+
+    Layout Nmbr9AnchorBoard::layout() const {
+        Layout result;
+        for (int i = 0; i < ncards_; ++i) {
+            const int p = deck_[i].val();
+            if (p >= nparts_) {
+                continue;
+            }
+            result.emplace_back(Placement{p, tile_level_[p].val() - 1, x_[p].val(), y_[p].val(),
+                                          orientation_[p].val()});
+        }
+        return result;
+    }
+}
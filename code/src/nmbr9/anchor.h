@@ -0,0 +1,108 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_ANCHOR_H
+#define NMBR9_ANCHOR_H
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
+
+#include "lib.h"
+#include "tiles.h"
+#include "base.h"
+
+#include <gecode/driver.hh>
+#include <gecode/int.hh>
+
+#include <vector>
+
+namespace nmbr9 {
+
+    /**
+     * Alternative model where each part is placed using an anchor into the precomputed footprints of its tile,
+     * instead of running a regular constraint over placement boards for each part and level.
+     *
+     * The anchor of a part determines its column, row and orientation. The boards, deck, order, levels, and score
+     * are the same as in Nmbr9Board, and the same on top propagator is used.
+     */
+    class Nmbr9AnchorBoard : public Gecode::IntMaximizeScript {
+    private:
+        /// The current instance used
+        const Instance instance_;
+
+        /// Size (width/height) of the board (wh_ is s)
+        const int wh_;
+        /// Number of board levels (nlevels_ is l_\top)
+        const int nlevels_;
+        /// Number of tiles that can be placed (nparts_ is n)
+        const int nparts_;
+        /// Number of cards in the deck (ncards_ is k)
+        const int ncards_;
+        /// Number of board squares, wh_*wh_
+        const int nsquares_;
+
+        /// The variables for the board. (boards[l] is G_l)
+        std::vector<Gecode::IntVarArray> boards_;
+
+        /// The variables representing the chosen tiles. (tile_is_used_[p] is Y_p)
+        Gecode::BoolVarArray tile_is_used_;
+
+        /// The variables representing is a tile is on . (matrix(tile_is_on_level_, nparts_, nlevels_)(p, l) is L_pl)
+        Gecode::BoolVarArray tile_is_on_level_;
+
+        /// Tile value (tile_value_[p] is v(p))
+        Gecode::IntSharedArray tile_value_;
+
+        /// Tile level (tile_level_[p] is L_p)
+        Gecode::IntVarArray tile_level_;
+
+        /// The index of the footprint used for each part. Since 0 is also the index of a footprint, an unused part
+        /// is not identified by its anchor but by tile_is_used_, and its anchor is pinned to 0 by
+        /// !tile_is_used_ >> anchor == 0.
+        Gecode::IntVarArray anchor_;
+
+        /// The column of the bounding box of each part
+        Gecode::IntVarArray x_;
+
+        /// The row of the bounding box of each part
+        Gecode::IntVarArray y_;
+
+        /// The orientation (index of the tile alternative) of each part
+        Gecode::IntVarArray orientation_;
+
+        /// The deck of cards. (deck_[i] is D(i))
+        Gecode::IntVarArray deck_;
+
+        /// The order of parts in the deck, or >= ncards_ if the part is not used (order_[p] is O(p)).
+        Gecode::IntVarArray order_;
+
+        /// The score of the solution (score_ is S)
+        Gecode::IntVar score_;
+
+    public:
+        /// Construction of the model.
+        explicit Nmbr9AnchorBoard(const Nmbr9Options& opts);
+
+        /// Constructor for cloning \a s
+        Nmbr9AnchorBoard(Nmbr9AnchorBoard &s);
+
+        /// Copy space during cloning
+        Nmbr9AnchorBoard *copy() override;
+
+        /// Print solution
+        void print(std::ostream &os) const override;
+
+        Gecode::IntVar cost() const override;
+
+        /**
+         * Extract the placements of a solution, for checking with a Verifier.
+         * The deck and the anchors must be assigned.
+         */
+        Layout layout() const;
+    };
+}
+
+#pragma clang diagnostic pop
+
+#endif //NMBR9_ANCHOR_H
@@ -0,0 +1,414 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "anchoring.h"
+#include "bitboard.h"
+
+#include <gecode/int.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstdint>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    namespace {
+        /**
+         * Propagator placing a part on the boards using an anchor into the footprints of its tile.
+         *
+         * Anchors and levels where the footprint does not fit on the boards are removed. When the level is known,
+         * the squares covered by all remaining footprints are assigned to the part, and the part is removed from
+         * all squares not covered by any remaining footprint.
+         */
+        class AnchoredPlacement : public Propagator {
+        protected:
+            /// The squares of all levels, level l uses the squares l*nsquares to (l+1)*nsquares-1
+            ViewArray<Int::IntView> boards_;
+            /// The level of the part plus one, or 0 if the part is not used
+            Int::IntView level_;
+            /// The index of the footprint used
+            Int::IntView anchor_;
+            /// The part placed
+            const int part_;
+            /// The number of levels
+            const int nlevels_;
+            /// The footprints of the tile of the part
+            const FootprintTable& footprints_;
+
+            /// Constructor for posting
+            AnchoredPlacement(Home home, ViewArray<Int::IntView>& boards, Int::IntView level, Int::IntView anchor,
+                              int part, int nlevels, const FootprintTable& footprints)
+                    : Propagator(home), boards_(boards), level_(level), anchor_(anchor),
+                      part_(part), nlevels_(nlevels), footprints_(footprints) {
+                boards_.subscribe(home, *this, Int::PC_INT_DOM);
+                level_.subscribe(home, *this, Int::PC_INT_DOM);
+                anchor_.subscribe(home, *this, Int::PC_INT_DOM);
+            }
+
+            /// Constructor for cloning \a p
+            AnchoredPlacement(Space& home, AnchoredPlacement& p)
+                    : Propagator(home, p), part_(p.part_), nlevels_(p.nlevels_), footprints_(p.footprints_) {
+                boards_.update(home, p.boards_);
+                level_.update(home, p.level_);
+                anchor_.update(home, p.anchor_);
+            }
+
+        public:
+            /// Post the propagator
+            static ExecStatus post(Home home, ViewArray<Int::IntView>& boards, Int::IntView level,
+                                   Int::IntView anchor, int part, int nlevels,
+                                   const FootprintTable& footprints) {
+                (void) new (home) AnchoredPlacement(home, boards, level, anchor, part, nlevels, footprints);
+                return ES_OK;
+            }
+
+            Propagator* copy(Space& home) override {
+                return new (home) AnchoredPlacement(home, *this);
+            }
+
+            PropCost cost(const Space&, const ModEventDelta&) const override {
+                return PropCost::linear(PropCost::HI, boards_.size());
+            }
+
+            void reschedule(Space& home) override {
+                boards_.reschedule(home, *this, Int::PC_INT_DOM);
+                level_.reschedule(home, *this, Int::PC_INT_DOM);
+                anchor_.reschedule(home, *this, Int::PC_INT_DOM);
+            }
+
+            size_t dispose(Space& home) override {
+                boards_.cancel(home, *this, Int::PC_INT_DOM);
+                level_.cancel(home, *this, Int::PC_INT_DOM);
+                anchor_.cancel(home, *this, Int::PC_INT_DOM);
+                (void) Propagator::dispose(home);
+                return sizeof(*this);
+            }
+
+            ExecStatus propagate(Space& home, const ModEventDelta&) override {
+                const int value = part_ + 1;
+                const int nsquares = boards_.size() / nlevels_;
+
+                if (footprints_.empty()) {
+                    GECODE_ME_CHECK(level_.eq(home, 0));
+                }
+
+                if (level_.assigned() && level_.val() == 0) {
+                    for (int i = 0; i < boards_.size(); ++i) {
+                        GECODE_ME_CHECK(boards_[i].nq(home, value));
+                    }
+                    GECODE_ME_CHECK(anchor_.eq(home, 0));
+                    return home.ES_SUBSUMED(*this);
+                }
+
+                // The squares where the part may be, for each level that is still possible
+                Region r;
+                const int words = footprints_.words();
+                std::uint64_t* allowed = r.alloc<std::uint64_t>(nlevels_ * words);
+                for (Int::ViewValues<Int::IntView> level(level_); level(); ++level) {
+                    if (level.val() == 0) {
+                        continue;
+                    }
+                    const int l = level.val() - 1;
+                    bitboard::clear(allowed + l * words, words);
+                    for (int s = 0; s < nsquares; ++s) {
+                        if (boards_[l * nsquares + s].in(value)) {
+                            bitboard::set(allowed + l * words, s);
+                        }
+                    }
+                }
+
+                // Find the levels and anchors where the footprint fits
+                bool* level_fits = r.alloc<bool>(nlevels_);
+                for (int l = 0; l < nlevels_; ++l) {
+                    level_fits[l] = false;
+                }
+                int* misfits = r.alloc<int>(anchor_.size());
+                int nmisfits = 0;
+                for (Int::ViewValues<Int::IntView> a(anchor_); a(); ++a) {
+                    const Footprint& footprint = footprints_[a.val()];
+                    bool fits = false;
+                    for (Int::ViewValues<Int::IntView> level(level_); level(); ++level) {
+                        if (level.val() == 0) {
+                            continue;
+                        }
+                        const int l = level.val() - 1;
+                        if (bitboard::subset(footprint.mark_bits, allowed + l * words, words)) {
+                            level_fits[l] = true;
+                            fits = true;
+                        }
+                    }
+                    if (!fits) {
+                        misfits[nmisfits++] = a.val();
+                    }
+                }
+                for (int l = 0; l < nlevels_; ++l) {
+                    if (!level_fits[l]) {
+                        GECODE_ME_CHECK(level_.nq(home, l + 1));
+                    }
+                }
+                if (level_.min() > 0) {
+                    // The part is used, so the anchor must fit (an unused part has anchor 0)
+                    for (int i = 0; i < nmisfits; ++i) {
+                        GECODE_ME_CHECK(anchor_.nq(home, misfits[i]));
+                    }
+                }
+
+                if (level_.assigned() && level_.val() > 0) {
+                    const int on_level = level_.val() - 1;
+                    for (int l = 0; l < nlevels_; ++l) {
+                        if (l != on_level) {
+                            for (int s = 0; s < nsquares; ++s) {
+                                GECODE_ME_CHECK(boards_[l * nsquares + s].nq(home, value));
+                            }
+                        }
+                    }
+
+                    // Squares covered by all and by any of the remaining footprints
+                    std::uint64_t* all = r.alloc<std::uint64_t>(words);
+                    std::uint64_t* any = r.alloc<std::uint64_t>(words);
+                    bitboard::clear(any, words);
+                    bool first = true;
+                    for (Int::ViewValues<Int::IntView> a(anchor_); a(); ++a) {
+                        const std::uint64_t* marks = footprints_[a.val()].mark_bits;
+                        if (first) {
+                            std::copy(marks, marks + words, all);
+                            first = false;
+                        } else {
+                            bitboard::keep(all, marks, words);
+                        }
+                        bitboard::add(any, marks, words);
+                    }
+                    const int offset = on_level * nsquares;
+                    for (int s = 0; s < nsquares; ++s) {
+                        if (bitboard::test(all, s)) {
+                            GECODE_ME_CHECK(boards_[offset + s].eq(home, value));
+                        } else if (!bitboard::test(any, s)) {
+                            GECODE_ME_CHECK(boards_[offset + s].nq(home, value));
+                        }
+                    }
+
+                    if (anchor_.assigned()) {
+                        return home.ES_SUBSUMED(*this);
+                    }
+                }
+
+                return ES_NOFIX;
+            }
+        };
+
+        /**
+         * Propagator for the connectedness requirement (9) on one level, with parts placed using anchors.
+         *
+         * Works like the propagator for the board model, but a part is connected through the squares around its
+         * remaining footprints. When a part on the level is known not to be first, footprints that can not be
+         * connected to an earlier part are removed.
+         */
+        class AnchoredConnected : public Propagator {
+        protected:
+            /// The squares of the level
+            ViewArray<Int::IntView> board_;
+            /// The order of the parts in the deck
+            ViewArray<Int::IntView> order_;
+            /// Whether the parts are on the level
+            ViewArray<Int::BoolView> on_level_;
+            /// The anchors of the parts
+            ViewArray<Int::IntView> anchors_;
+            /// The footprints of the tiles of the parts
+            const FootprintTable** footprints_;
+
+            /// Constructor for posting
+            AnchoredConnected(Home home,
+                              ViewArray<Int::IntView>& board, ViewArray<Int::IntView>& order,
+                              ViewArray<Int::BoolView>& on_level, ViewArray<Int::IntView>& anchors,
+                              const std::vector<const FootprintTable*>& footprints)
+                    : Propagator(home), board_(board), order_(order), on_level_(on_level), anchors_(anchors),
+                      footprints_(home.alloc<const FootprintTable*>(footprints.size())) {
+                std::copy(footprints.begin(), footprints.end(), footprints_);
+                board_.subscribe(home, *this, Int::PC_INT_DOM);
+                order_.subscribe(home, *this, Int::PC_INT_BND);
+                on_level_.subscribe(home, *this, Int::PC_BOOL_VAL);
+                anchors_.subscribe(home, *this, Int::PC_INT_DOM);
+            }
+
+            /// Constructor for cloning \a p
+            AnchoredConnected(Space& home, AnchoredConnected& p)
+                    : Propagator(home, p),
+                      footprints_(home.alloc<const FootprintTable*>(p.anchors_.size())) {
+                std::copy(p.footprints_, p.footprints_ + p.anchors_.size(), footprints_);
+                board_.update(home, p.board_);
+                order_.update(home, p.order_);
+                on_level_.update(home, p.on_level_);
+                anchors_.update(home, p.anchors_);
+            }
+
+        public:
+            /// Post the propagator
+            static ExecStatus post(Home home,
+                                   ViewArray<Int::IntView>& board, ViewArray<Int::IntView>& order,
+                                   ViewArray<Int::BoolView>& on_level, ViewArray<Int::IntView>& anchors,
+                                   const std::vector<const FootprintTable*>& footprints) {
+                (void) new (home) AnchoredConnected(home, board, order, on_level, anchors, footprints);
+                return ES_OK;
+            }
+
+            Propagator* copy(Space& home) override {
+                return new (home) AnchoredConnected(home, *this);
+            }
+
+            PropCost cost(const Space&, const ModEventDelta&) const override {
+                return PropCost::quadratic(PropCost::HI, board_.size());
+            }
+
+            void reschedule(Space& home) override {
+                board_.reschedule(home, *this, Int::PC_INT_DOM);
+                order_.reschedule(home, *this, Int::PC_INT_BND);
+                on_level_.reschedule(home, *this, Int::PC_BOOL_VAL);
+                anchors_.reschedule(home, *this, Int::PC_INT_DOM);
+            }
+
+            size_t dispose(Space& home) override {
+                board_.cancel(home, *this, Int::PC_INT_DOM);
+                order_.cancel(home, *this, Int::PC_INT_BND);
+                on_level_.cancel(home, *this, Int::PC_BOOL_VAL);
+                anchors_.cancel(home, *this, Int::PC_INT_DOM);
+                home.free<const FootprintTable*>(footprints_, anchors_.size());
+                (void) Propagator::dispose(home);
+                return sizeof(*this);
+            }
+
+            ExecStatus propagate(Space& home, const ModEventDelta&) override {
+                const int nparts = order_.size();
+                const int nsquares = board_.size();
+
+                // The earliest order of a part that may occupy each square
+                Region r;
+                int* earliest = r.alloc<int>(nsquares);
+                for (int s = 0; s < nsquares; ++s) {
+                    earliest[s] = INT_MAX;
+                    for (Int::ViewValues<Int::IntView> v(board_[s]); v(); ++v) {
+                        const int q = v.val() - 1;
+                        if (q >= 0 && !on_level_[q].zero()) {
+                            earliest[s] = std::min(earliest[s], order_[q].min());
+                        }
+                    }
+                }
+
+                unsigned int max_anchors = 0;
+                for (int p = 0; p < nparts; ++p) {
+                    max_anchors = std::max(max_anchors, anchors_[p].size());
+                }
+                int* unconnected = r.alloc<int>(max_anchors);
+                std::uint64_t* before = r.alloc<std::uint64_t>(bitboard::words_for(nsquares));
+
+                for (int p = 0; p < nparts; ++p) {
+                    if (on_level_[p].zero()) {
+                        continue;
+                    }
+
+                    // The squares occupied by some part that may be before the part
+                    const FootprintTable& footprints = *footprints_[p];
+                    const int words = footprints.words();
+                    bitboard::clear(before, words);
+                    for (int s = 0; s < nsquares; ++s) {
+                        if (earliest[s] < order_[p].max()) {
+                            bitboard::set(before, s);
+                        }
+                    }
+
+                    int nunconnected = 0;
+                    bool may_connect = false;
+                    for (Int::ViewValues<Int::IntView> a(anchors_[p]); a(); ++a) {
+                        if (bitboard::intersects(footprints[a.val()].around_bits, before, words)) {
+                            may_connect = true;
+                        } else {
+                            unconnected[nunconnected++] = a.val();
+                        }
+                    }
+
+                    bool has_before = false;
+                    for (int q = 0; q < nparts; ++q) {
+                        if (q != p && on_level_[q].one() && order_[q].max() < order_[p].min()) {
+                            has_before = true;
+                            break;
+                        }
+                    }
+
+                    if (may_connect) {
+                        if (has_before && on_level_[p].one()) {
+                            // The part must be connected, so only connected footprints remain
+                            for (int i = 0; i < nunconnected; ++i) {
+                                GECODE_ME_CHECK(anchors_[p].nq(home, unconnected[i]));
+                            }
+                        }
+                        continue;
+                    }
+
+                    if (has_before) {
+                        // The part can not be connected to any earlier part, so it is not on this level
+                        GECODE_ME_CHECK(on_level_[p].zero(home));
+                        continue;
+                    }
+
+                    if (on_level_[p].one()) {
+                        // The part can not be connected, so it must be the first part on this level
+                        for (int q = 0; q < nparts; ++q) {
+                            if (q == p) {
+                                continue;
+                            }
+                            if (on_level_[q].one()) {
+                                GECODE_ME_CHECK(order_[q].gq(home, order_[p].min() + 1));
+                                GECODE_ME_CHECK(order_[p].lq(home, order_[q].max() - 1));
+                            } else if (!on_level_[q].zero() && order_[q].max() < order_[p].min()) {
+                                GECODE_ME_CHECK(on_level_[q].zero(home));
+                            }
+                        }
+                    }
+                }
+
+                if (board_.assigned() && order_.assigned() && on_level_.assigned() && anchors_.assigned()) {
+                    return home.ES_SUBSUMED(*this);
+                }
+                return ES_NOFIX;
+            }
+        };
+    }
+
+    void anchored_placement(Home home,
+                            const std::vector<IntVarArray>& boards,
+                            IntVar level,
+                            IntVar anchor,
+                            int part,
+                            const FootprintTable& footprints) {
+        GECODE_POST;
+
+        IntVarArgs all_boards;
+        for (const auto& board : boards) {
+            all_boards << IntVarArgs(board);
+        }
+        ViewArray<Int::IntView> board_views(home, all_boards);
+        GECODE_ES_FAIL(AnchoredPlacement::post(home, board_views, level, anchor,
+                                               part, static_cast<int>(boards.size()), footprints));
+    }
+
+    void anchored_connected(Home home,
+                            const IntVarArgs& board,
+                            const IntVarArgs& order,
+                            const BoolVarArgs& on_level,
+                            const IntVarArgs& anchors,
+                            const std::vector<const FootprintTable*>& footprints) {
+        assert(anchors.size() == order.size() && footprints.size() == order.size());
+        assert(on_level.size() == order.size());
+        GECODE_POST;
+
+        ViewArray<Int::IntView> board_views(home, board);
+        ViewArray<Int::IntView> order_views(home, order);
+        ViewArray<Int::BoolView> on_level_views(home, on_level);
+        ViewArray<Int::IntView> anchor_views(home, anchors);
+        GECODE_ES_FAIL(AnchoredConnected::post(home, board_views, order_views, on_level_views, anchor_views,
+                                               footprints));
+    }
+}
@@ -0,0 +1,58 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_ANCHORING_H
+#define NMBR9_ANCHORING_H
+
+#include "footprints.h"
+
+#include <gecode/int.hh>
+
+#include <vector>
+
+namespace nmbr9 {
+
+    /**
+     * Post the placement of a part given by an anchor into the footprints of its tile.
+     *
+     * If the part is on level l (\a level is l+1) and \a anchor is a, then the squares of footprint a on level l
+     * have value part+1, and no other square on any level has value part+1. If the part is not used (\a level
+     * is 0), then \a anchor is 0 and no square has value part+1.
+     *
+     * @param home The space to post the constraint in
+     * @param boards The squares of all levels, from the bottom level to the top level
+     * @param level The level of the part plus one, or 0 if the part is not used
+     * @param anchor The index of the footprint used for the part
+     * @param part The part
+     * @param footprints The footprints of the tile of the part, must outlive the space
+     */
+    void anchored_placement(Gecode::Home home,
+                            const std::vector<Gecode::IntVarArray>& boards,
+                            Gecode::IntVar level,
+                            Gecode::IntVar anchor,
+                            int part,
+                            const FootprintTable& footprints);
+
+    /**
+     * Post the connectedness requirement (9) for one level, with parts placed using anchors.
+     *
+     * If a part is on the level and some other part is placed before it on the same level, then some square
+     * around the footprint of the part must be occupied by a part that is before it in the order.
+     *
+     * @param home The space to post the constraint in
+     * @param board The squares of the level, value p+1 when occupied by part p and 0 when empty
+     * @param order The order of the parts in the deck
+     * @param on_level The parts that are on the level
+     * @param anchors The anchors of the parts
+     * @param footprints The footprints of the tiles of the parts, must outlive the space
+     */
+    void anchored_connected(Gecode::Home home,
+                            const Gecode::IntVarArgs& board,
+                            const Gecode::IntVarArgs& order,
+                            const Gecode::BoolVarArgs& on_level,
+                            const Gecode::IntVarArgs& anchors,
+                            const std::vector<const FootprintTable*>& footprints);
+}
+
+#endif //NMBR9_ANCHORING_H
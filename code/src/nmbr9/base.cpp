@@ -26,6 +26,12 @@ namespace nmbr9 {
         return !(rhs == *this);
     }
 
+    bool Instance::same_tiles(const Instance &rhs) const {
+        return max_value_ == rhs.max_value_ &&
+               copies_ == rhs.copies_ &&
+               wh_ == rhs.wh_;
+    }
+
     bool Instance::operator<(const Instance &rhs) const {
         if (play_type_ < rhs.play_type_)
             return true;
@@ -12,6 +12,50 @@ namespace nmbr9 {
         PT_KNOWN,
     } PlayType;
 
+    typedef enum {
+        PE_CHANNEL, ///< Placement boards channeled to Boolean part and around boards
+        PE_COMPACT, ///< Placement boards connected directly to the level boards
+    } PlacementEncoding;
+
+    typedef enum {
+        MT_BOARD,  ///< Placements by regular constraints over placement boards (Nmbr9Board)
+        MT_ANCHOR, ///< Placements by anchors into precomputed footprints (Nmbr9AnchorBoard)
+    } ModelType;
+
+    typedef enum {
+        SV_MIN,    ///< Place the part with the smallest number on a square
+        SV_RANDOM, ///< Place a random part on a square
+    } SpiralValue;
+
+    typedef enum {
+        PB_SPIRAL, ///< Squares in spiral order from the center, levels in part order
+        PB_AFC,    ///< Largest accumulated failure count first
+        PB_ACTION, ///< Largest action first
+        PB_CHB,    ///< Largest conflict history first
+        PB_FOOTPRINT, ///< Whole footprints for the parts in deck order, then squares in spiral order
+    } PlacementBranching;
+
+    typedef enum {
+        ET_SCRIPT, ///< Search for the best layout with the model
+        ET_VERIFY, ///< Verify layouts read from standard input
+        ET_AUTO_GRID, ///< Search on growing grids, up to the grid size
+        ET_DEEPENING, ///< Search with growing numbers of layers, up to the maximum number of layers
+        ET_STREAM, ///< Play cards from standard input as they are revealed
+        ET_EVALUATE, ///< Estimate the expected score of streaming play over random decks
+        ET_BATCH, ///< Run the jobs on standard input, sharing the models between jobs
+    } EngineType;
+
+    typedef enum {
+        GS_BOUND,    ///< Stop growing the grid when the best score reaches the upper bound
+        GS_FEASIBLE, ///< Stop growing the grid at the first grid with a layout
+        GS_PLATEAU,  ///< Stop growing the grid at the first larger grid without a better layout
+    } GridStop;
+
+    typedef enum {
+        OF_TEXT,  ///< The boards of the solutions and the statistics as text
+        OF_JSONL, ///< One JSON object per line for each improving solution, and one for the end of the search
+    } OutputFormat;
+
     /**
      * Unique representation of a a problem instance, including the size of the grid
      * since that affects the placement expressions produced.
@@ -37,6 +81,8 @@ namespace nmbr9 {
         bool operator>(const Instance &rhs) const;
         bool operator<=(const Instance &rhs) const;
         bool operator>=(const Instance &rhs) const;
+        /// True if the tiles of \a rhs are the same, which only depend on the values, the copies, and the grid size
+        [[nodiscard]] bool same_tiles(const Instance &rhs) const;
     };
 }
 
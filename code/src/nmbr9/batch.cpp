@@ -0,0 +1,241 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "batch.h"
+#include "pool.h"
+
+#include <gecode/search.hh>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    namespace {
+        /// One line of the batch
+        struct Job {
+            /// The index of the job in the input
+            int index;
+            /// The line with the options
+            std::string line;
+            /// The parsed options
+            std::unique_ptr<Nmbr9Options> options;
+            /// The index of the model for the job
+            int root;
+        };
+
+        /// A model shared by all jobs with the same model_key
+        struct Root {
+            /// The model without heuristics, after the initial propagation
+            std::unique_ptr<Nmbr9Board> space;
+            /// Whether the model failed in the initial propagation
+            bool failed;
+            /// Cloning changes the space that is cloned, so only one job at a time may clone it
+            std::mutex mutex;
+        };
+
+        /**
+         * The options that the model of a job is built from, which are all the options used by the model except
+         * the seed. Jobs with the same key share the model, whatever the order of their options.
+         */
+        std::string model_key(const Nmbr9Options& options) {
+            std::ostringstream key;
+            key << options.play_type() << ' ' << options.max_value() << ' ' << options.copies() << ' '
+                << options.deck_size() << ' ' << options.grid_size() << ' ' << options.max_layers() << ' '
+                << options.placement_encoding() << ' ' << options.ipl() << ' '
+                << options.use_deck_level_symmetry() << ' ' << options.use_translation_symmetry() << ' '
+                << options.use_score_bound() << ' ' << options.spiral_value() << ' '
+                << options.placement_branching() << ' ' << options.decay() << ' ' << options.solution_guided();
+            return key.str();
+        }
+
+        /**
+         * Check that the options of a job can be run by the batch, which only runs single-threaded branch and
+         * bound on the board model.
+         *
+         * @return The reason the job can not be run, or an empty string if it can
+         */
+        std::string unsupported_options(const Nmbr9Options& options) {
+            if (options.engine() != ET_SCRIPT) {
+                return "-engine";
+            }
+            if (options.model() != MT_BOARD) {
+                return "-model";
+            }
+            if (options.assets() > 0) {
+                return "-assets";
+            }
+            if (options.restart() != RM_NONE) {
+                return "-restart";
+            }
+            if (options.lns() > 0) {
+                return "-lns";
+            }
+            if (options.threads() != 1) {
+                return "-threads";
+            }
+            if (options.output() != OF_TEXT) {
+                return "-output";
+            }
+            return "";
+        }
+    }
+
+    bool parse_options(const std::string& line, Nmbr9Options& options, std::string& error) {
+        std::istringstream is(line);
+        std::vector<std::string> tokens{"nmbr9"};
+        std::string token;
+        while (is >> token) {
+            if (token == "-help" || token == "--help" || token == "-?") {
+                error = "help is not an option to run with";
+                return false;
+            }
+            tokens.emplace_back(token);
+        }
+
+        std::vector<char*> argv;
+        for (auto& t : tokens) {
+            argv.emplace_back(t.data());
+        }
+        argv.emplace_back(nullptr);
+        int argc = static_cast<int>(tokens.size());
+
+        // The Gecode parser exits on a malformed value, so it is first tried in a child process
+        std::cout.flush();
+        std::cerr.flush();
+        const pid_t pid = fork();
+        if (pid < 0) {
+            error = "the options could not be checked";
+            return false;
+        }
+        if (pid == 0) {
+            Nmbr9Options trial;
+            trial.Options::parse(argc, argv.data());
+            _exit(EXIT_SUCCESS);
+        }
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            error = "malformed value for some option";
+            return false;
+        }
+
+        options.Options::parse(argc, argv.data());
+        if (argc != 1) {
+            error = std::string("unknown option ") + argv[1];
+            return false;
+        }
+        error = options.validate();
+        return error.empty();
+    }
+
+    int run_batch(const Nmbr9Options& opt) {
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<Job> jobs;
+        std::map<std::string, int> roots_by_key;
+        int errors = 0;
+        int index = 0;
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            const auto first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') {
+                continue;
+            }
+            Job job{index++, line, std::make_unique<Nmbr9Options>(), -1};
+            std::string error;
+            if (!parse_options(line, *job.options, error)) {
+                std::cout << "Job " << job.index << ": " << error << ", in " << line << std::endl;
+                ++errors;
+                continue;
+            }
+            const std::string unsupported = unsupported_options(*job.options);
+            if (!unsupported.empty()) {
+                std::cout << "Job " << job.index << ": " << unsupported << " is not supported in a batch, in "
+                          << line << std::endl;
+                ++errors;
+                continue;
+            }
+            const auto root = roots_by_key.emplace(model_key(*job.options), static_cast<int>(roots_by_key.size()));
+            job.root = root.first->second;
+            jobs.emplace_back(std::move(job));
+        }
+
+        // Jobs with the same model are next to each other, so that workers mostly clone the same model
+        std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+            return a.root < b.root;
+        });
+        std::vector<int> first_job(roots_by_key.size(), -1);
+        for (int j = static_cast<int>(jobs.size()) - 1; j >= 0; --j) {
+            first_job[jobs[j].root] = j;
+        }
+
+        const int workers = worker_count(opt.threads());
+        std::vector<std::unique_ptr<Root>> roots(roots_by_key.size());
+        parallel_for(static_cast<int>(roots.size()), workers, [&](int, const int r) {
+            roots[r] = std::make_unique<Root>();
+            roots[r]->space = std::make_unique<Nmbr9Board>(*jobs[first_job[r]].options, Layout(), false);
+            roots[r]->failed = roots[r]->space->status() == SS_FAILED;
+        });
+        const std::chrono::duration<double, std::milli> setup = std::chrono::steady_clock::now() - start;
+        std::cout << "Built " << roots.size() << " models for " << jobs.size() << " jobs in "
+                  << setup.count() << " ms" << std::endl;
+
+        std::mutex output;
+        work_stealing_for(static_cast<int>(jobs.size()), workers, [&](int, const int j) {
+            const auto job_start = std::chrono::steady_clock::now();
+            const Job& job = jobs[j];
+            Root& root = *roots[job.root];
+
+            int best_score = -1;
+            Search::Statistics statistics;
+            bool stopped = false;
+            if (root.failed) {
+                // No layouts at all for the options
+            } else {
+                std::unique_ptr<Nmbr9Board> model;
+                {
+                    std::lock_guard<std::mutex> lock(root.mutex);
+                    model.reset(static_cast<Nmbr9Board*>(root.space->clone()));
+                }
+                model->post_heuristics(job.options->seed());
+
+                Search::Options so;
+                so.threads = 1;
+                std::unique_ptr<Search::Stop> stop;
+                if (job.options->time() > 0) {
+                    stop = std::make_unique<Search::TimeStop>(job.options->time());
+                    so.stop = stop.get();
+                }
+                BAB<Nmbr9Board> engine(model.get(), so);
+                while (Nmbr9Board* solution = engine.next()) {
+                    best_score = solution->cost().val();
+                    delete solution;
+                }
+                statistics = engine.statistics();
+                stopped = engine.stopped();
+            }
+
+            const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - job_start;
+            std::lock_guard<std::mutex> lock(output);
+            std::cout << "Job " << job.index << ": best score " << best_score
+                      << (stopped ? " (stopped)" : "")
+                      << ", nodes " << statistics.node << ", failures " << statistics.fail
+                      << ", time " << duration.count() << " ms, options " << job.line << std::endl;
+        });
+
+        return errors;
+    }
+}
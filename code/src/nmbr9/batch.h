@@ -0,0 +1,42 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_BATCH_H
+#define NMBR9_BATCH_H
+
+#include "lib.h"
+
+#include <string>
+
+namespace nmbr9 {
+
+    /**
+     * Parse options written as on the command line.
+     *
+     * Unlike Nmbr9Options::parse, this never exits the process. Since the Gecode parser exits on malformed
+     * values, the line is first parsed in a child process, and -help is rejected.
+     *
+     * @param line The options, separated by whitespace
+     * @param options The options to parse into
+     * @param error Set to the reason when the options can not be used
+     * @return False if some option is not known, has a malformed value, or does not pass Nmbr9Options::validate
+     */
+    bool parse_options(const std::string& line, Nmbr9Options& options, std::string& error);
+
+    /**
+     * Run the jobs on standard input, one per line, and print one result record per job as it finishes.
+     *
+     * Each job is a line of options for the board model, as on the command line, where -seed gives the seed
+     * for the heuristics and -time the time limit for the job. Empty lines and lines starting with # are
+     * skipped. The model is constructed once for all jobs that only differ in the seed and the time limit,
+     * whatever the order of their options, and each job searches a clone of it. The jobs run single-threaded
+     * branch and bound on a work-stealing pool with the threads in \a opt, so jobs with other engines, the
+     * anchor model, a portfolio, restarts, large neighbourhood search, threads, or JSON output are rejected.
+     *
+     * @return The number of jobs that could not be run
+     */
+    int run_batch(const Nmbr9Options& opt);
+}
+
+#endif //NMBR9_BATCH_H
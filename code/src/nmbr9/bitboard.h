@@ -0,0 +1,131 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_BITBOARD_H
+#define NMBR9_BITBOARD_H
+
+#include <cstdint>
+#include <vector>
+
+namespace nmbr9::bitboard {
+
+    /// Number of squares in one word of a bitboard
+    constexpr int word_bits = 64;
+
+    /// Number of words in one cache line
+    constexpr int line_words = 8;
+
+    /// One cache line of bitboard words, the unit of storage for bitboards
+    struct alignas(64) Line {
+        std::uint64_t words[line_words];
+    };
+
+    /**
+     * Bitboards are stored as whole cache lines, so that every bitboard starts on a cache line boundary.
+     *
+     * @param nsquares The number of squares on the board
+     * @return The number of words used for a bitboard with \a nsquares squares
+     */
+    inline int words_for(int nsquares) {
+        const int words = (nsquares + word_bits - 1) / word_bits;
+        return ((words + line_words - 1) / line_words) * line_words;
+    }
+
+    /// Mark square \a s in \a b
+    inline void set(std::uint64_t* b, int s) {
+        b[s / word_bits] |= std::uint64_t(1) << (s % word_bits);
+    }
+
+    /// Test if square \a s is marked in \a b
+    inline bool test(const std::uint64_t* b, int s) {
+        return (b[s / word_bits] >> (s % word_bits)) & 1u;
+    }
+
+    /// Clear all squares in \a b
+    inline void clear(std::uint64_t* b, int words) {
+        for (int i = 0; i < words; ++i) {
+            b[i] = 0;
+        }
+    }
+
+    /// Test if \a a and \a b have a common square
+    inline bool intersects(const std::uint64_t* a, const std::uint64_t* b, int words) {
+        std::uint64_t common = 0;
+        for (int i = 0; i < words; ++i) {
+            common |= a[i] & b[i];
+        }
+        return common != 0;
+    }
+
+    /// Test if all squares in \a a are also in \a b
+    inline bool subset(const std::uint64_t* a, const std::uint64_t* b, int words) {
+        std::uint64_t outside = 0;
+        for (int i = 0; i < words; ++i) {
+            outside |= a[i] & ~b[i];
+        }
+        return outside == 0;
+    }
+
+    /// Number of squares marked in \a b
+    inline int popcount(const std::uint64_t* b, int words) {
+        int result = 0;
+        for (int i = 0; i < words; ++i) {
+            result += __builtin_popcountll(b[i]);
+        }
+        return result;
+    }
+
+    /// Add all squares in \a b to \a a
+    inline void add(std::uint64_t* a, const std::uint64_t* b, int words) {
+        for (int i = 0; i < words; ++i) {
+            a[i] |= b[i];
+        }
+    }
+
+    /// Keep only the squares in \a a that are also in \a b
+    inline void keep(std::uint64_t* a, const std::uint64_t* b, int words) {
+        for (int i = 0; i < words; ++i) {
+            a[i] &= b[i];
+        }
+    }
+
+    /** \brief A bitboard owning its storage
+     *
+     * The storage is cache aligned, and the words beyond the squares of the board are always zero.
+     */
+    class Bitboard {
+        int words_; ///< Number of words used
+        std::vector<Line> lines_; ///< The storage
+    public:
+        explicit Bitboard(int nsquares = 0)
+                : words_(words_for(nsquares)),
+                  lines_(words_ / line_words, Line{}) {}
+
+        int words() const {
+            return words_;
+        }
+
+        std::uint64_t* data() {
+            return lines_.empty() ? nullptr : lines_.front().words;
+        }
+
+        const std::uint64_t* data() const {
+            return lines_.empty() ? nullptr : lines_.front().words;
+        }
+
+        void set(int s) {
+            bitboard::set(data(), s);
+        }
+
+        bool test(int s) const {
+            return bitboard::test(data(), s);
+        }
+
+        void clear() {
+            bitboard::clear(data(), words_);
+        }
+    };
+}
+
+#endif //NMBR9_BITBOARD_H
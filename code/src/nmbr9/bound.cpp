@@ -0,0 +1,188 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "bound.h"
+
+#include <gecode/int.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    namespace {
+        /**
+         * The largest number of parts on each level or higher, 0 for level 0.
+         *
+         * @param areas The area of each part
+         * @param ncards The number of cards in the deck
+         * @param nlevels The number of levels
+         * @param capacity The number of squares on a level that a part can occupy
+         */
+        std::vector<int> parts_at_or_above(const std::vector<int>& areas, int ncards, int nlevels, int capacity) {
+            // The number of parts that fit on one level, using the smallest parts
+            std::vector<int> sorted_areas(areas);
+            std::sort(sorted_areas.begin(), sorted_areas.end());
+            int per_level = 0;
+            int used_area = 0;
+            for (int area : sorted_areas) {
+                if (used_area + area > capacity) {
+                    break;
+                }
+                used_area += area;
+                ++per_level;
+            }
+
+            std::vector<int> result(nlevels, 0);
+            for (int l = 1; l < nlevels; ++l) {
+                result[l] = std::max(0, std::min(ncards - 2 * l, per_level * (nlevels - l)));
+            }
+            return result;
+        }
+
+        /**
+         * Propagator bounding the score from above, see score_bound.
+         */
+        class ScoreBound : public Propagator {
+        protected:
+            /// The level of each part plus one, or 0 if the part is not used
+            ViewArray<Int::IntView> level_;
+            /// The score
+            Int::IntView score_;
+            /// The parts ordered by decreasing value
+            IntSharedArray by_value_;
+            /// The value of each part
+            IntSharedArray values_;
+            /// The largest number of parts on level l or higher, 0 for level 0
+            IntSharedArray at_or_above_;
+
+            /// Constructor for posting
+            ScoreBound(Home home, ViewArray<Int::IntView>& level, Int::IntView score,
+                       const IntSharedArray& by_value, const IntSharedArray& values,
+                       const IntSharedArray& at_or_above)
+                    : Propagator(home), level_(level), score_(score),
+                      by_value_(by_value), values_(values), at_or_above_(at_or_above) {
+                level_.subscribe(home, *this, Int::PC_INT_BND);
+            }
+
+            /// Constructor for cloning \a p
+            ScoreBound(Space& home, ScoreBound& p)
+                    : Propagator(home, p), by_value_(p.by_value_), values_(p.values_), at_or_above_(p.at_or_above_) {
+                level_.update(home, p.level_);
+                score_.update(home, p.score_);
+            }
+
+        public:
+            /// Post the propagator
+            static ExecStatus post(Home home, ViewArray<Int::IntView>& level, Int::IntView score,
+                                   const IntSharedArray& by_value, const IntSharedArray& values,
+                                   const IntSharedArray& at_or_above) {
+                (void) new (home) ScoreBound(home, level, score, by_value, values, at_or_above);
+                return ES_OK;
+            }
+
+            Propagator* copy(Space& home) override {
+                return new (home) ScoreBound(home, *this);
+            }
+
+            PropCost cost(const Space&, const ModEventDelta&) const override {
+                return PropCost::quadratic(PropCost::LO, level_.size());
+            }
+
+            void reschedule(Space& home) override {
+                level_.reschedule(home, *this, Int::PC_INT_BND);
+            }
+
+            size_t dispose(Space& home) override {
+                level_.cancel(home, *this, Int::PC_INT_BND);
+                (void) Propagator::dispose(home);
+                return sizeof(*this);
+            }
+
+            ExecStatus propagate(Space& home, const ModEventDelta&) override {
+                // For each level l >= 1, the largest values of the parts that may reach it
+                int bound = 0;
+                for (int l = 1; l < at_or_above_.size(); ++l) {
+                    int remaining = at_or_above_[l];
+                    for (int i = 0; i < by_value_.size() && remaining > 0; ++i) {
+                        const int p = by_value_[i];
+                        if (level_[p].max() > l) {
+                            bound += values_[p];
+                            --remaining;
+                        }
+                    }
+                }
+                GECODE_ME_CHECK(score_.lq(home, bound));
+
+                if (level_.assigned()) {
+                    return home.ES_SUBSUMED(*this);
+                }
+                return ES_FIX;
+            }
+        };
+    }
+
+    void score_bound(Home home,
+                     const IntVarArgs& level,
+                     const IntArgs& values,
+                     const IntArgs& areas,
+                     const int ncards,
+                     const int capacity,
+                     IntVar score) {
+        assert(values.size() == level.size() && areas.size() == level.size());
+        GECODE_POST;
+
+        const int nparts = level.size();
+        int nlevels = 0;
+        for (int p = 0; p < nparts; ++p) {
+            nlevels = std::max(nlevels, level[p].max());
+        }
+
+        const std::vector<int> limits = parts_at_or_above(std::vector<int>(areas.begin(), areas.end()),
+                                                          ncards, nlevels, capacity);
+        IntSharedArray at_or_above(nlevels);
+        for (int l = 0; l < nlevels; ++l) {
+            at_or_above[l] = limits[l];
+        }
+
+        std::vector<int> parts(nparts);
+        for (int p = 0; p < nparts; ++p) {
+            parts[p] = p;
+        }
+        std::stable_sort(parts.begin(), parts.end(), [&](int a, int b) {
+            return values[a] > values[b];
+        });
+        IntSharedArray by_value(nparts);
+        IntSharedArray part_values(nparts);
+        for (int i = 0; i < nparts; ++i) {
+            by_value[i] = parts[i];
+            part_values[i] = values[i];
+        }
+
+        ViewArray<Int::IntView> level_views(home, level);
+        GECODE_ES_FAIL(ScoreBound::post(home, level_views, score, by_value, part_values, at_or_above));
+    }
+
+    int score_upper_bound(const std::vector<int>& values,
+                          const std::vector<int>& areas,
+                          const int ncards,
+                          const int nlevels,
+                          const int capacity) {
+        assert(values.size() == areas.size());
+        const std::vector<int> at_or_above = parts_at_or_above(areas, ncards, nlevels, capacity);
+        std::vector<int> sorted_values(values);
+        std::sort(sorted_values.rbegin(), sorted_values.rend());
+
+        int bound = 0;
+        for (int l = 1; l < nlevels; ++l) {
+            for (int i = 0; i < at_or_above[l] && i < sorted_values.size(); ++i) {
+                bound += sorted_values[i];
+            }
+        }
+        return bound;
+    }
+}
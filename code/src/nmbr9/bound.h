@@ -0,0 +1,57 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_BOUND_H
+#define NMBR9_BOUND_H
+
+#include <gecode/int.hh>
+
+#include <vector>
+
+namespace nmbr9 {
+
+    /**
+     * Post an upper bound on the score from the levels the parts can still reach.
+     *
+     * A part on level l has at least two earlier parts on every level below it, so at most ncards-2l cards are
+     * on level l or higher. Each level also holds at most the number of parts that fit in its area. The score is
+     * the sum over the levels l >= 1 of the values of the parts on level l or higher, and each of these sums is
+     * bounded by the largest values of the parts that may reach level l, as many as there may be on level l or
+     * higher.
+     *
+     * @param home The space to post the constraint in
+     * @param level The level of each part plus one, or 0 if the part is not used
+     * @param values The value of each part
+     * @param areas The area of each part
+     * @param ncards The number of cards in the deck
+     * @param capacity The number of squares on a level that a part can occupy
+     * @param score The score, sum of the value times the level of the used parts
+     */
+    void score_bound(Gecode::Home home,
+                     const Gecode::IntVarArgs& level,
+                     const Gecode::IntArgs& values,
+                     const Gecode::IntArgs& areas,
+                     int ncards,
+                     int capacity,
+                     Gecode::IntVar score);
+
+    /**
+     * The bound of score_bound before any part is placed, which holds for all grids with at most \a capacity
+     * squares inside the border.
+     *
+     * @param values The value of each part
+     * @param areas The area of each part
+     * @param ncards The number of cards in the deck
+     * @param nlevels The number of levels
+     * @param capacity The number of squares on a level that a part can occupy
+     * @return An upper bound on the score of any layout
+     */
+    int score_upper_bound(const std::vector<int>& values,
+                          const std::vector<int>& areas,
+                          int ncards,
+                          int nlevels,
+                          int capacity);
+}
+
+#endif //NMBR9_BOUND_H
@@ -0,0 +1,129 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "common.h"
+#include "bound.h"
+#include "symmetry.h"
+#include "tiles.h"
+
+#include <gecode/minimodel.hh>
+
+#include <cmath>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    void implied_levels(Home home,
+                        const Instance instance,
+                        const std::vector<IntVarArray>& boards,
+                        const BoolVarArgs& tile_is_on_level,
+                        const IntVarArgs& deck,
+                        const IntVarArgs& tile_level) {
+        const int nparts = tile_level.size();
+        const int nlevels = static_cast<int>(boards.size());
+        const int wh = instance.wh();
+        const int nsquares = wh * wh;
+        Matrix<BoolVarArgs> mtile_is_on_level(tile_is_on_level, nparts, nlevels);
+
+        // Each level needs two cards before the next level can be filled
+        for (int i = 0; i < deck.size(); ++i) {
+            int max_level = (int) ceil(((double) i+1) / 2);
+            rel(home, element(tile_level, deck[i]) <= max_level);
+        }
+
+        // Each layer must have at most the area of the previous layer. The area of a layer is the number of
+        // occupied squares on its board, which can be at most the squares inside the border.
+        IntArgs tile_area;
+        for (int p = 0; p < nparts; ++p) {
+            tile_area << nmbr9::tile_area(instance, p+1);
+        }
+        IntVarArgs level_areas;
+        IntVarArgs level_counts;
+        for (int l = 0; l < nlevels; ++l) {
+            IntVar level_area(home, 0, (wh-2)*(wh-2));
+            linear(home, tile_area, mtile_is_on_level.row(l), IRT_EQ, level_area);
+            count(home, boards[l], 0, IRT_EQ, expr(home, nsquares - level_area));
+
+            level_areas << level_area;
+            level_counts << expr(home, sum(mtile_is_on_level.row(l)));
+        }
+        for (int i = 0; i < level_areas.size() - 1; ++i) {
+            rel(home, level_areas[i], IRT_GQ, level_areas[i+1]);
+            // A part on the next layer rests on two different parts on this layer
+            rel(home, (level_counts[i+1] > 0) >> (level_counts[i] >= 2));
+        }
+    }
+
+    void break_symmetries(Home home,
+                          const Nmbr9Options& options,
+                          const IntVarArgs& base,
+                          const IntVarArgs& deck,
+                          const IntVarArgs& tile_level,
+                          const bool layout_symmetries) {
+        const int nparts = tile_level.size();
+        const int wh = options.grid_size();
+
+        // Copies of the same value can be fixed order in the deck
+        int copies = (int) options.copies();
+        for (int p = 0; p < nparts; p += copies) {
+            IntArgs same_values;
+            for (int c = 0; c < copies; ++c) {
+                same_values << (p + c);
+            }
+            precede(home, deck, same_values);
+        }
+
+        if (!layout_symmetries) {
+            return;
+        }
+
+        // Rotational symmetry on the base grid
+
+        // Type for tile vector<int> symmetry functions
+        typedef void (*varsymmfunc)(const IntVarArgs &, int, int, IntVarArgs &, int &, int &);
+        const std::vector<varsymmfunc> symmetries {
+                symmetry::rot90, symmetry::rot180, symmetry::rot270
+        };
+        for (const auto& symmetry : symmetries) {
+            IntVarArgs rotated_grid(wh * wh);
+            int gs = wh;
+            symmetry(base, gs, gs, rotated_grid, gs, gs);
+            rel(home, base, IRT_GQ, rotated_grid);
+        }
+
+        // Translational symmetry on the base grid, compatible with the rotational symmetry breaking
+        if (options.use_translation_symmetry()) {
+            symmetry::centered(home, base, wh);
+        }
+
+        if (options.use_deck_level_symmetry()) {
+            // Symmetry breaking suggested by Ciaran McCreesh at CP2019
+            // When solving the free play type, we can decide that all the tiles on the bottom level are first in the deck.
+            // Unfortunately, this did not seem to help, even though it should.
+            if (options.play_type() == PT_FREE) {
+                for (int c = 0; c < deck.size() - 1; ++c) {
+                    rel(home, element(tile_level, deck[c]) <= element(tile_level, deck[c + 1]));
+                }
+            }
+        }
+    }
+
+    void bound_score(Home home,
+                     const Nmbr9Options& options,
+                     const IntVarArgs& tile_level,
+                     IntVar score) {
+        if (!options.use_score_bound()) {
+            return;
+        }
+        const Instance instance = options.instance();
+        const int wh = instance.wh();
+        IntArgs values, areas;
+        for (int p = 0; p < tile_level.size(); ++p) {
+            values << nmbr9::tile_value(instance, p+1);
+            areas << nmbr9::tile_area(instance, p+1);
+        }
+        score_bound(home, tile_level, values, areas, options.deck_size(), (wh-2) * (wh-2), score);
+    }
+}
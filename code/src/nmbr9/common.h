@@ -0,0 +1,73 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_COMMON_H
+#define NMBR9_COMMON_H
+
+#include "base.h"
+#include "lib.h"
+
+#include <gecode/int.hh>
+
+#include <vector>
+
+namespace nmbr9 {
+
+    /**
+     * Post the implied constraints on the levels, which are the same for all models.
+     *
+     * A card can only be on a level if there are two cards before it for each level below. The area of a level
+     * is the area of its parts, which is the number of occupied squares on its board, at most the squares inside
+     * the border, and at most the area of the level below. A level that holds some part needs at least two parts
+     * on the level below.
+     *
+     * @param home The space to post the constraints in
+     * @param instance The instance, for the areas of the parts
+     * @param boards The squares of all levels, from the bottom level to the top level
+     * @param tile_is_on_level Whether part p is on level l, at index l*nparts+p
+     * @param deck The part of each card
+     * @param tile_level The level of each part plus one, or 0 if the part is not used
+     */
+    void implied_levels(Gecode::Home home,
+                        Instance instance,
+                        const std::vector<Gecode::IntVarArray>& boards,
+                        const Gecode::BoolVarArgs& tile_is_on_level,
+                        const Gecode::IntVarArgs& deck,
+                        const Gecode::IntVarArgs& tile_level);
+
+    /**
+     * Post the symmetry breaking constraints selected in the options, which are the same for all models.
+     *
+     * The copies of a value are used in order in the deck. The bottom level is the lex-largest of its rotations,
+     * and with -translation-symmetry it is centered. With -deck-level-symmetry and free play, the levels of the
+     * cards are ordered in the deck.
+     *
+     * The symmetries of the layout remove layouts that are legal continuations of a partly placed deck, so
+     * without \a layout_symmetries only the symmetry between the copies is broken.
+     *
+     * @param home The space to post the constraints in
+     * @param options The options
+     * @param base The squares of the bottom level
+     * @param deck The part of each card
+     * @param tile_level The level of each part plus one, or 0 if the part is not used
+     * @param layout_symmetries False to leave out the rotations, the translations and the deck levels
+     */
+    void break_symmetries(Gecode::Home home,
+                          const Nmbr9Options& options,
+                          const Gecode::IntVarArgs& base,
+                          const Gecode::IntVarArgs& deck,
+                          const Gecode::IntVarArgs& tile_level,
+                          bool layout_symmetries = true);
+
+    /**
+     * Post the upper bound from score_bound when it is enabled in the options, with the values and areas of the
+     * parts of the instance.
+     */
+    void bound_score(Gecode::Home home,
+                     const Nmbr9Options& options,
+                     const Gecode::IntVarArgs& tile_level,
+                     Gecode::IntVar score);
+}
+
+#endif //NMBR9_COMMON_H
@@ -0,0 +1,215 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "connected.h"
+
+#include <gecode/int.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    namespace {
+        /// Access to the around boards, depending on how they are encoded
+        template<class View>
+        struct Around;
+
+        /// Around boards as Boolean variables
+        template<>
+        struct Around<Int::BoolView> {
+            static constexpr PropCond pc = Int::PC_BOOL_VAL;
+            static bool possible(const Int::BoolView& x) {
+                return !x.zero();
+            }
+        };
+
+        /// Around boards as the value 2 of the placement boards
+        template<>
+        struct Around<Int::IntView> {
+            static constexpr PropCond pc = Int::PC_INT_DOM;
+            static bool possible(const Int::IntView& x) {
+                return x.in(2);
+            }
+        };
+
+        /**
+         * Propagator for the connectedness requirement (9) on one level.
+         *
+         * For every square the earliest possible order of a part that may occupy it is computed once per
+         * propagation. A part may be connected to an earlier part if some square that may be around it has an
+         * earliest order that is smaller than the latest possible order of the part.
+         *
+         * \tparam AroundView The type of view used for the around boards
+         */
+        template<class AroundView>
+        class Connected : public Propagator {
+        protected:
+            /// The squares of the level
+            ViewArray<Int::IntView> board_;
+            /// The order of the parts in the deck
+            ViewArray<Int::IntView> order_;
+            /// Whether the parts are on the level
+            ViewArray<Int::BoolView> on_level_;
+            /// The around boards of the parts, part p uses the squares p*board_.size() to (p+1)*board_.size()-1
+            ViewArray<AroundView> around_;
+
+            /// Constructor for posting
+            Connected(Home home,
+                      ViewArray<Int::IntView>& board, ViewArray<Int::IntView>& order,
+                      ViewArray<Int::BoolView>& on_level, ViewArray<AroundView>& around)
+                    : Propagator(home), board_(board), order_(order), on_level_(on_level), around_(around) {
+                board_.subscribe(home, *this, Int::PC_INT_DOM);
+                order_.subscribe(home, *this, Int::PC_INT_BND);
+                on_level_.subscribe(home, *this, Int::PC_BOOL_VAL);
+                around_.subscribe(home, *this, Around<AroundView>::pc);
+            }
+
+            /// Constructor for cloning \a p
+            Connected(Space& home, Connected& p)
+                    : Propagator(home, p) {
+                board_.update(home, p.board_);
+                order_.update(home, p.order_);
+                on_level_.update(home, p.on_level_);
+                around_.update(home, p.around_);
+            }
+
+        public:
+            /// Post the propagator
+            static ExecStatus post(Home home,
+                                   ViewArray<Int::IntView>& board, ViewArray<Int::IntView>& order,
+                                   ViewArray<Int::BoolView>& on_level, ViewArray<AroundView>& around) {
+                (void) new (home) Connected(home, board, order, on_level, around);
+                return ES_OK;
+            }
+
+            Propagator* copy(Space& home) override {
+                return new (home) Connected(home, *this);
+            }
+
+            PropCost cost(const Space&, const ModEventDelta&) const override {
+                return PropCost::linear(PropCost::HI, around_.size());
+            }
+
+            void reschedule(Space& home) override {
+                board_.reschedule(home, *this, Int::PC_INT_DOM);
+                order_.reschedule(home, *this, Int::PC_INT_BND);
+                on_level_.reschedule(home, *this, Int::PC_BOOL_VAL);
+                around_.reschedule(home, *this, Around<AroundView>::pc);
+            }
+
+            size_t dispose(Space& home) override {
+                board_.cancel(home, *this, Int::PC_INT_DOM);
+                order_.cancel(home, *this, Int::PC_INT_BND);
+                on_level_.cancel(home, *this, Int::PC_BOOL_VAL);
+                around_.cancel(home, *this, Around<AroundView>::pc);
+                (void) Propagator::dispose(home);
+                return sizeof(*this);
+            }
+
+            ExecStatus propagate(Space& home, const ModEventDelta&) override {
+                const int nparts = order_.size();
+                const int nsquares = board_.size();
+
+                // The earliest order of a part that may occupy each square
+                Region r;
+                int* earliest = r.alloc<int>(nsquares);
+                for (int s = 0; s < nsquares; ++s) {
+                    earliest[s] = INT_MAX;
+                    for (Int::ViewValues<Int::IntView> v(board_[s]); v(); ++v) {
+                        const int q = v.val() - 1;
+                        if (q >= 0 && !on_level_[q].zero()) {
+                            earliest[s] = std::min(earliest[s], order_[q].min());
+                        }
+                    }
+                }
+
+                for (int p = 0; p < nparts; ++p) {
+                    if (on_level_[p].zero()) {
+                        continue;
+                    }
+
+                    bool may_connect = false;
+                    for (int s = 0; s < nsquares; ++s) {
+                        if (Around<AroundView>::possible(around_[p * nsquares + s]) && earliest[s] < order_[p].max()) {
+                            may_connect = true;
+                            break;
+                        }
+                    }
+                    if (may_connect) {
+                        continue;
+                    }
+
+                    bool has_before = false;
+                    for (int q = 0; q < nparts; ++q) {
+                        if (q != p && on_level_[q].one() && order_[q].max() < order_[p].min()) {
+                            has_before = true;
+                            break;
+                        }
+                    }
+                    if (has_before) {
+                        // The part can not be connected to any earlier part, so it is not on this level
+                        GECODE_ME_CHECK(on_level_[p].zero(home));
+                        continue;
+                    }
+
+                    if (on_level_[p].one()) {
+                        // The part can not be connected, so it must be the first part on this level
+                        for (int q = 0; q < nparts; ++q) {
+                            if (q == p) {
+                                continue;
+                            }
+                            if (on_level_[q].one()) {
+                                GECODE_ME_CHECK(order_[q].gq(home, order_[p].min() + 1));
+                                GECODE_ME_CHECK(order_[p].lq(home, order_[q].max() - 1));
+                            } else if (!on_level_[q].zero() && order_[q].max() < order_[p].min()) {
+                                GECODE_ME_CHECK(on_level_[q].zero(home));
+                            }
+                        }
+                    }
+                }
+
+                if (board_.assigned() && order_.assigned() && on_level_.assigned() && around_.assigned()) {
+                    return home.ES_SUBSUMED(*this);
+                }
+                return ES_NOFIX;
+            }
+        };
+    }
+
+    void connected(Home home,
+                   const IntVarArgs& board,
+                   const IntVarArgs& order,
+                   const BoolVarArgs& on_level,
+                   const BoolVarArgs& around) {
+        assert(around.size() == board.size() * order.size());
+        assert(on_level.size() == order.size());
+        GECODE_POST;
+
+        ViewArray<Int::IntView> board_views(home, board);
+        ViewArray<Int::IntView> order_views(home, order);
+        ViewArray<Int::BoolView> on_level_views(home, on_level);
+        ViewArray<Int::BoolView> around_views(home, around);
+        GECODE_ES_FAIL(Connected<Int::BoolView>::post(home, board_views, order_views, on_level_views, around_views));
+    }
+
+    void connected(Home home,
+                   const IntVarArgs& board,
+                   const IntVarArgs& order,
+                   const BoolVarArgs& on_level,
+                   const IntVarArgs& placements) {
+        assert(placements.size() == board.size() * order.size());
+        assert(on_level.size() == order.size());
+        GECODE_POST;
+
+        ViewArray<Int::IntView> board_views(home, board);
+        ViewArray<Int::IntView> order_views(home, order);
+        ViewArray<Int::BoolView> on_level_views(home, on_level);
+        ViewArray<Int::IntView> placement_views(home, placements);
+        GECODE_ES_FAIL(Connected<Int::IntView>::post(home, board_views, order_views, on_level_views, placement_views));
+    }
+}
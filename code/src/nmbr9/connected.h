@@ -0,0 +1,48 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_CONNECTED_H
+#define NMBR9_CONNECTED_H
+
+#include <gecode/int.hh>
+
+namespace nmbr9 {
+
+    /**
+     * Post the connectedness requirement (9) for one level.
+     *
+     * If a part is on the level and some other part is placed before it on the same level, then some square
+     * around the part must be occupied by a part that is before it in the order. The propagator works
+     * directly on the board, so no auxiliary variables are created per pair of parts.
+     *
+     * @param home The space to post the constraint in
+     * @param board The squares of the level, value p+1 when occupied by part p and 0 when empty
+     * @param order The order of the parts in the deck
+     * @param on_level The parts that are on the level
+     * @param around The around boards of the level for all the parts, concatenated in part order
+     */
+    void connected(Gecode::Home home,
+                   const Gecode::IntVarArgs& board,
+                   const Gecode::IntVarArgs& order,
+                   const Gecode::BoolVarArgs& on_level,
+                   const Gecode::BoolVarArgs& around);
+
+    /**
+     * Post the connectedness requirement (9) for one level, for the compact placement encoding.
+     *
+     * @param home The space to post the constraint in
+     * @param board The squares of the level, value p+1 when occupied by part p and 0 when empty
+     * @param order The order of the parts in the deck
+     * @param on_level The parts that are on the level
+     * @param placements The placement boards of the level for all the parts, concatenated in part order,
+     *                   where the value 2 marks the squares around a part
+     */
+    void connected(Gecode::Home home,
+                   const Gecode::IntVarArgs& board,
+                   const Gecode::IntVarArgs& order,
+                   const Gecode::BoolVarArgs& on_level,
+                   const Gecode::IntVarArgs& placements);
+}
+
+#endif //NMBR9_CONNECTED_H
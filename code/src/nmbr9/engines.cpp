@@ -0,0 +1,227 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "engines.h"
+#include "bound.h"
+#include "tiles.h"
+#include "verify.h"
+
+#include <gecode/search.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    int run_verify(const Nmbr9Options& opt) {
+        auto now = [] { return std::chrono::steady_clock::now(); };
+
+        Verifier verifier(opt.instance(), opt.max_layers());
+        Layout layout;
+        std::vector<VerificationResult> results;
+        const auto verify_start = now();
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (parse_layout(line, layout)) {
+                results.emplace_back(verifier.verify(layout));
+            } else {
+                results.emplace_back(VerificationResult{false, 0, -1, "the line is not a layout"});
+            }
+        }
+        const auto verify_end = now();
+        const std::chrono::duration<double, std::milli> verify_duration = verify_end - verify_start;
+
+        int illegal = 0;
+        for (const auto& result : results) {
+            if (result.legal) {
+                std::cout << "legal " << result.score << std::endl;
+            } else {
+                ++illegal;
+                std::cout << "illegal " << result.card << " " << result.reason << std::endl;
+            }
+        }
+        std::cout << "Verified " << results.size() << " layouts, " << illegal << " illegal, in "
+                  << verify_duration.count() << std::endl;
+        return illegal;
+    }
+
+    int minimal_grid_size(const Nmbr9Options& opt) {
+        const Instance instance = opt.instance();
+        std::vector<int> sizes, areas;
+        for (int p = 0; p < instance.number_of_parts(); ++p) {
+            const Tile& shape = tile(instance, p + 1).alternatives().front();
+            sizes.emplace_back(std::max(shape.width(), shape.height()));
+            areas.emplace_back(tile_area(instance, p + 1));
+        }
+        std::sort(sizes.begin(), sizes.end());
+        std::sort(areas.begin(), areas.end());
+
+        const int ncards = opt.deck_size();
+        if (ncards == 0) {
+            return 2;
+        }
+        // The grid includes the border, just as the bounding boxes include the squares around the tiles
+        const int fits_some_card = sizes[ncards - 1];
+
+        int deck_area = 0;
+        for (int c = 0; c < ncards; ++c) {
+            deck_area += areas[c];
+        }
+        const int usable_levels = std::min(opt.max_layers(), (ncards - 1) / 2 + 1);
+        const int bottom_area = (deck_area + usable_levels - 1) / usable_levels;
+        const int fits_bottom = 2 + static_cast<int>(std::ceil(std::sqrt(static_cast<double>(bottom_area))));
+
+        return std::max(fits_some_card, fits_bottom);
+    }
+
+    namespace {
+        /**
+         * Search stop for the remaining part of the time limit in the options.
+         *
+         * @param start The time the run started
+         * @param stop Set to the stop to use, or nullptr if there is no time limit
+         * @return False if the time limit is already reached
+         */
+        bool remaining_time(const Nmbr9Options& opt,
+                            std::chrono::steady_clock::time_point start,
+                            std::unique_ptr<Search::Stop>& stop) {
+            stop.reset();
+            if (opt.time() == 0) {
+                return true;
+            }
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            const double remaining = static_cast<double>(opt.time()) - elapsed.count();
+            if (remaining <= 0) {
+                return false;
+            }
+            stop = std::make_unique<Search::TimeStop>(static_cast<unsigned long int>(remaining));
+            return true;
+        }
+    }
+
+    int run_auto_grid(Nmbr9Options& opt) {
+        auto now = [] { return std::chrono::steady_clock::now(); };
+        const auto start = now();
+
+        const int max_wh = opt.grid_size();
+        const int min_wh = std::min(max_wh, minimal_grid_size(opt));
+
+        // The bound for the largest grid holds for all the smaller grids as well
+        std::vector<int> values, areas;
+        for (int p = 0; p < opt.number_of_parts(); ++p) {
+            values.emplace_back(tile_value(opt.instance(), p + 1));
+            areas.emplace_back(tile_area(opt.instance(), p + 1));
+        }
+        const int upper_bound = score_upper_bound(values, areas, opt.deck_size(), opt.max_layers(),
+                                                  (max_wh - 2) * (max_wh - 2));
+
+        int best_score = -1;
+        std::unique_ptr<Nmbr9Board> best;
+        for (int wh = min_wh; wh <= max_wh && best_score < upper_bound; ++wh) {
+            opt.grid_size(wh);
+            auto* model = new Nmbr9Board(opt);
+            if (best_score >= 0) {
+                rel(*model, model->cost(), IRT_GR, best_score);
+            }
+
+            Search::Options so;
+            so.threads = opt.threads();
+            std::unique_ptr<Search::Stop> stop;
+            if (!remaining_time(opt, start, stop)) {
+                delete model;
+                break;
+            }
+            so.stop = stop.get();
+
+            BAB<Nmbr9Board> engine(model, so);
+            delete model;
+            const int previous_score = best_score;
+            while (Nmbr9Board* solution = engine.next()) {
+                best_score = solution->cost().val();
+                best.reset(solution);
+            }
+
+            const Search::Statistics statistics = engine.statistics();
+            std::cout << "Grid size " << wh << ": best score " << best_score
+                      << (engine.stopped() ? " (stopped)" : "")
+                      << ", nodes " << statistics.node << ", failures " << statistics.fail << std::endl;
+            if (engine.stopped()) {
+                break;
+            }
+            // The heuristic stopping criteria, a larger grid may still hold a better layout
+            if (opt.grid_stop() == GS_FEASIBLE && best_score >= 0) {
+                break;
+            }
+            if (opt.grid_stop() == GS_PLATEAU && previous_score >= 0 && best_score == previous_score) {
+                break;
+            }
+        }
+        opt.grid_size(max_wh);
+
+        if (best) {
+            best->print(std::cout);
+        } else {
+            std::cout << "No solution found" << std::endl;
+        }
+        return best_score;
+    }
+
+    int run_deepening(Nmbr9Options& opt) {
+        const auto start = std::chrono::steady_clock::now();
+        const int max_layers = opt.max_layers();
+
+        int best_score = -1;
+        Layout best_layout;
+        std::unique_ptr<Nmbr9Board> best;
+        for (int layers = std::min(2, max_layers); layers <= max_layers; ++layers) {
+            opt.max_layers(layers);
+            auto* model = new Nmbr9Board(opt, best_layout);
+            if (best_score >= 0) {
+                rel(*model, model->cost(), IRT_GR, best_score);
+            }
+
+            Search::Options so;
+            so.threads = opt.threads();
+            std::unique_ptr<Search::Stop> stop;
+            if (!remaining_time(opt, start, stop)) {
+                delete model;
+                break;
+            }
+            so.stop = stop.get();
+
+            BAB<Nmbr9Board> engine(model, so);
+            delete model;
+            while (Nmbr9Board* solution = engine.next()) {
+                best_score = solution->cost().val();
+                best.reset(solution);
+            }
+            if (best) {
+                best_layout = best->layout();
+            }
+
+            const Search::Statistics statistics = engine.statistics();
+            std::cout << "Layers " << layers << ": best score " << best_score
+                      << (engine.stopped() ? " (stopped)" : "")
+                      << ", nodes " << statistics.node << ", failures " << statistics.fail << std::endl;
+            if (engine.stopped()) {
+                break;
+            }
+        }
+        opt.max_layers(max_layers);
+
+        if (best) {
+            best->print(std::cout);
+        } else {
+            std::cout << "No solution found" << std::endl;
+        }
+        return best_score;
+    }
+}
@@ -0,0 +1,60 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_ENGINES_H
+#define NMBR9_ENGINES_H
+
+#include "lib.h"
+
+namespace nmbr9 {
+
+    /**
+     * Verify the layouts on standard input, one per line, and report the result for each.
+     *
+     * @return The number of layouts that are not legal
+     */
+    int run_verify(const Nmbr9Options& opt);
+
+    /**
+     * The smallest grid where a full deck can be laid out.
+     *
+     * The grid must fit the bounding box of the tile of some card, and since the areas of the levels do not
+     * increase, the bottom level must hold at least the total area of the smallest possible deck divided by the
+     * number of levels that can be used.
+     *
+     * @param opt The options, the grid size is ignored
+     * @return A lower bound on the grid size for the instance
+     */
+    int minimal_grid_size(const Nmbr9Options& opt);
+
+    /**
+     * Search for the best layout on growing grids, from minimal_grid_size up to the grid size in the options.
+     *
+     * A layout on a grid is also a layout on all larger grids, so each grid only looks for layouts that are
+     * better than the best one so far. The search stops when the largest grid is done, when the time limit is
+     * reached, or as given by the grid-stop option. By default that is at the first larger grid without a better
+     * layout, and with feasible at the first grid with a layout, both of which may miss better layouts on the
+     * larger grids. With bound, the search is exact and stops when the best layout meets the upper bound on the
+     * score, but the bound is computed for the largest grid and is rarely met, so then every grid is searched.
+     *
+     * @param opt The options, the grid size is changed while running and restored at the end
+     * @return The best score found, or -1 if there is none
+     */
+    int run_auto_grid(Nmbr9Options& opt);
+
+    /**
+     * Search for the best layout with growing numbers of layers, from 2 up to the maximum number of layers in the
+     * options.
+     *
+     * Each depth only looks for layouts that are better than the best one so far, and uses the best layout so
+     * far as a hint for the heuristics. The search stops when the largest depth is done, or when the time limit
+     * is reached.
+     *
+     * @param opt The options, the maximum number of layers is changed while running
+     * @return The best score found, or -1 if there is none
+     */
+    int run_deepening(Nmbr9Options& opt);
+}
+
+#endif //NMBR9_ENGINES_H
@@ -0,0 +1,245 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "footprint_branching.h"
+#include "bitboard.h"
+#include "tiles.h"
+
+#include <gecode/int.hh>
+
+#include <algorithm>
+#include <ostream>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    namespace {
+        /// Choice of a footprint for a part
+        class FootprintChoice : public Choice {
+        public:
+            /// The part to place
+            int part;
+            /// The level to place it on
+            int level;
+            /// The number of footprints that fit
+            int n;
+            /// The footprints that fit, one per alternative
+            int* footprints;
+
+            FootprintChoice(const Brancher& b, int part, int level, int n)
+                    : Choice(b, std::max(n, 1)), part(part), level(level), n(n), footprints(new int[std::max(n, 1)]) {}
+
+            ~FootprintChoice() override {
+                delete[] footprints;
+            }
+
+            void archive(Archive& e) const override {
+                Choice::archive(e);
+                e << part << level << n;
+                for (int i = 0; i < n; ++i) {
+                    e << footprints[i];
+                }
+            }
+        };
+
+        /**
+         * Brancher placing one part at a time, with one alternative per footprint that fits.
+         */
+        class FootprintBrancher : public Brancher {
+        protected:
+            /// The squares of all levels, level l uses the squares l*nsquares to (l+1)*nsquares-1
+            ViewArray<Int::IntView> boards_;
+            /// The deck of cards
+            ViewArray<Int::IntView> deck_;
+            /// The level of each part plus one, or 0 if the part is not used
+            ViewArray<Int::IntView> level_;
+            /// The footprints of the tiles of the parts
+            const FootprintTable** footprints_;
+            /// The first card that might not be placed yet
+            mutable int start_;
+            /// Number of squares on each level
+            int squares_per_level_;
+
+            /**
+             * @return True if part \a p is on a level and some square on its level may still become the part
+             */
+            bool unplaced(int p) const {
+                if (!level_[p].assigned() || level_[p].val() == 0) {
+                    return false;
+                }
+                const int offset = (level_[p].val() - 1) * squares_per_level_;
+                for (int s = 0; s < squares_per_level_; ++s) {
+                    const Int::IntView square = boards_[offset + s];
+                    if (!square.assigned() && square.in(p + 1)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /**
+             * @return The part of the first card from \a start_ that should be placed, or -1 if there is none
+             */
+            int next_part() const {
+                for (int c = start_; c < deck_.size(); ++c) {
+                    if (!deck_[c].assigned()) {
+                        return -1;
+                    }
+                    const int p = deck_[c].val();
+                    if (p < level_.size() && unplaced(p)) {
+                        return p;
+                    }
+                }
+                return -1;
+            }
+
+            /// Constructor for posting
+            FootprintBrancher(Home home, ViewArray<Int::IntView>& boards, ViewArray<Int::IntView>& deck,
+                              ViewArray<Int::IntView>& level, const std::vector<const FootprintTable*>& footprints,
+                              int nsquares)
+                    : Brancher(home), boards_(boards), deck_(deck), level_(level),
+                      footprints_(home.alloc<const FootprintTable*>(footprints.size())), start_(0),
+                      squares_per_level_(nsquares) {
+                std::copy(footprints.begin(), footprints.end(), footprints_);
+            }
+
+            /// Constructor for cloning \a b
+            FootprintBrancher(Space& home, FootprintBrancher& b)
+                    : Brancher(home, b),
+                      footprints_(home.alloc<const FootprintTable*>(b.level_.size())), start_(b.start_),
+                      squares_per_level_(b.squares_per_level_) {
+                std::copy(b.footprints_, b.footprints_ + b.level_.size(), footprints_);
+                boards_.update(home, b.boards_);
+                deck_.update(home, b.deck_);
+                level_.update(home, b.level_);
+            }
+
+        public:
+            /// Post the brancher
+            static void post(Home home, ViewArray<Int::IntView>& boards, ViewArray<Int::IntView>& deck,
+                             ViewArray<Int::IntView>& level, const std::vector<const FootprintTable*>& footprints,
+                             int nsquares) {
+                (void) new (home) FootprintBrancher(home, boards, deck, level, footprints, nsquares);
+            }
+
+            bool status(const Space&) const override {
+                // Cards before start_ are placed, and stay placed in all descendants
+                while (start_ < deck_.size()) {
+                    if (!deck_[start_].assigned()) {
+                        return false;
+                    }
+                    const int p = deck_[start_].val();
+                    if (p < level_.size() && (!level_[p].assigned() || unplaced(p))) {
+                        break;
+                    }
+                    ++start_;
+                }
+                return next_part() >= 0;
+            }
+
+            const Choice* choice(Space&) override {
+                const int p = next_part();
+                const int l = level_[p].val() - 1;
+                const int offset = l * squares_per_level_;
+                const FootprintTable& footprints = *footprints_[p];
+
+                Region r;
+                int* fitting = r.alloc<int>(footprints.size());
+                int n = 0;
+                for (int i = 0; i < footprints.size(); ++i) {
+                    bool fits = true;
+                    for (int s : footprints[i].marks) {
+                        if (!boards_[offset + s].in(p + 1)) {
+                            fits = false;
+                            break;
+                        }
+                    }
+                    if (fits) {
+                        fitting[n++] = i;
+                    }
+                }
+
+                auto* c = new FootprintChoice(*this, p, l, n);
+                std::copy(fitting, fitting + n, c->footprints);
+                return c;
+            }
+
+            const Choice* choice(const Space&, Archive& e) override {
+                int p, l, n;
+                e >> p >> l >> n;
+                auto* c = new FootprintChoice(*this, p, l, n);
+                for (int i = 0; i < n; ++i) {
+                    e >> c->footprints[i];
+                }
+                return c;
+            }
+
+            ExecStatus commit(Space& home, const Choice& choice, unsigned int a) override {
+                const auto& c = static_cast<const FootprintChoice&>(choice);
+                if (c.n == 0) {
+                    return ES_FAILED;
+                }
+                const Footprint& footprint = (*footprints_[c.part])[c.footprints[a]];
+                const int offset = c.level * squares_per_level_;
+                const int value = c.part + 1;
+                for (int s = 0; s < squares_per_level_; ++s) {
+                    Int::IntView square = boards_[offset + s];
+                    if (bitboard::test(footprint.mark_bits, s)) {
+                        GECODE_ME_CHECK(square.eq(home, value));
+                    } else if (square.in(value)) {
+                        GECODE_ME_CHECK(square.nq(home, value));
+                    }
+                }
+                return ES_OK;
+            }
+
+            void print(const Space&, const Choice& choice, unsigned int a, std::ostream& o) const override {
+                const auto& c = static_cast<const FootprintChoice&>(choice);
+                if (c.n == 0) {
+                    o << "part " << c.part << " does not fit";
+                    return;
+                }
+                const Footprint& footprint = (*footprints_[c.part])[c.footprints[a]];
+                o << "part " << c.part << " on level " << c.level
+                  << " at (" << footprint.x << ", " << footprint.y << ") orientation " << footprint.orientation;
+            }
+
+            Actor* copy(Space& home) override {
+                return new (home) FootprintBrancher(home, *this);
+            }
+
+            size_t dispose(Space& home) override {
+                home.free<const FootprintTable*>(footprints_, level_.size());
+                (void) Brancher::dispose(home);
+                return sizeof(*this);
+            }
+        };
+    }
+
+    void branch_footprints(Home home,
+                           const Instance instance,
+                           const std::vector<IntVarArray>& boards,
+                           const IntVarArgs& deck,
+                           const IntVarArgs& level) {
+        if (home.failed()) {
+            return;
+        }
+
+        IntVarArgs all_boards;
+        for (const auto& board : boards) {
+            all_boards << IntVarArgs(board);
+        }
+        std::vector<const FootprintTable*> footprints;
+        for (int p = 0; p < level.size(); ++p) {
+            footprints.emplace_back(&nmbr9::footprints(instance, p + 1));
+        }
+
+        ViewArray<Int::IntView> board_views(home, all_boards);
+        ViewArray<Int::IntView> deck_views(home, deck);
+        ViewArray<Int::IntView> level_views(home, level);
+        FootprintBrancher::post(home, board_views, deck_views, level_views, footprints,
+                                instance.wh() * instance.wh());
+    }
+}
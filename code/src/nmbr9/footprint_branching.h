@@ -0,0 +1,37 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_FOOTPRINT_BRANCHING_H
+#define NMBR9_FOOTPRINT_BRANCHING_H
+
+#include "base.h"
+
+#include <gecode/int.hh>
+
+#include <vector>
+
+namespace nmbr9 {
+
+    /**
+     * Branch on complete placements of the parts, instead of on single squares.
+     *
+     * The parts are placed in deck order. For the first card whose part has a known level but is not yet placed,
+     * there is one alternative for each footprint of its tile that still fits on that level. Committing to an
+     * alternative places the part on the squares of the footprint, and removes it from all other squares on the
+     * level. Cards where the part or its level is not yet known are left to later branchings.
+     *
+     * @param home The space to post the brancher in
+     * @param instance The instance, used to find the footprints of the parts
+     * @param boards The squares of all levels, value p+1 when occupied by part p and 0 when empty
+     * @param deck The deck of cards
+     * @param level The level of each part plus one, or 0 if the part is not used
+     */
+    void branch_footprints(Gecode::Home home,
+                           Instance instance,
+                           const std::vector<Gecode::IntVarArray>& boards,
+                           const Gecode::IntVarArgs& deck,
+                           const Gecode::IntVarArgs& level);
+}
+
+#endif //NMBR9_FOOTPRINT_BRANCHING_H
@@ -0,0 +1,74 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "footprints.h"
+#include "tiles.h"
+
+#include <algorithm>
+
+namespace nmbr9 {
+
+    FootprintTable::FootprintTable(const TileSource &source, const int wh)
+            : wh_(wh), words_(bitboard::words_for(wh * wh)), footprints_(), bits_(), index_() {
+        const std::vector<Tile> &alternatives = source.alternatives();
+        for (int orientation = 0; orientation < alternatives.size(); ++orientation) {
+            const Tile &tile = alternatives[orientation];
+            for (int y = 0; y + tile.height() <= wh; ++y) {
+                for (int x = 0; x + tile.width() <= wh; ++x) {
+                    Footprint footprint{orientation, x, y, {}, {}, nullptr, nullptr};
+                    for (int ty = 0; ty < tile.height(); ++ty) {
+                        for (int tx = 0; tx < tile.width(); ++tx) {
+                            const int square = (y + ty) * wh + (x + tx);
+                            switch (tile.at(tx, ty)) {
+                                case 1:
+                                    footprint.marks.emplace_back(square);
+                                    break;
+                                case 2:
+                                    footprint.around.emplace_back(square);
+                                    break;
+                                default:
+                                    break;
+                            }
+                        }
+                    }
+                    footprints_.emplace_back(std::move(footprint));
+                }
+            }
+        }
+
+        // Twice the distance along each axis between the center of the bounding box and the center of the grid
+        const auto distance = [&](const Footprint &footprint) {
+            const Tile &tile = alternatives[footprint.orientation];
+            const int dx = 2 * footprint.x + tile.width() - wh;
+            const int dy = 2 * footprint.y + tile.height() - wh;
+            return dx * dx + dy * dy;
+        };
+        std::stable_sort(footprints_.begin(), footprints_.end(), [&](const Footprint &a, const Footprint &b) {
+            return distance(a) < distance(b);
+        });
+
+        index_.assign(alternatives.size() * wh * wh, -1);
+        for (int i = 0; i < footprints_.size(); ++i) {
+            const Footprint &footprint = footprints_[i];
+            index_[(footprint.orientation * wh + footprint.y) * wh + footprint.x] = i;
+        }
+
+        // Two bitboards per footprint, allocated once so that the pointers stay valid
+        const int lines = words_ / bitboard::line_words;
+        bits_.assign(2 * lines * footprints_.size(), bitboard::Line{});
+        for (int i = 0; i < footprints_.size(); ++i) {
+            Footprint &footprint = footprints_[i];
+            std::uint64_t *mark_bits = bits_[2 * i * lines].words;
+            std::uint64_t *around_bits = bits_[(2 * i + 1) * lines].words;
+            for (int s : footprint.marks) {
+                bitboard::set(mark_bits, s);
+            }
+            for (int s : footprint.around) {
+                bitboard::set(around_bits, s);
+            }
+            footprint.mark_bits = mark_bits;
+            footprint.around_bits = around_bits;
+        }
+    }
+}
@@ -0,0 +1,102 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_FOOTPRINTS_H
+#define NMBR9_FOOTPRINTS_H
+
+#include "bitboard.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace nmbr9 {
+    class TileSource;
+
+    /** \brief One legal placement of a tile on the grid
+     *
+     * A footprint is a tile alternative placed with the upper left corner of its bounding box (including the
+     * squares around the tile) at a position on the grid. Only placements where the whole bounding box is inside
+     * the grid are legal, which keeps the tile off the border just as the placement expressions do.
+     *
+     * The squares are available both as lists and as bitboards. The bitboards are owned by the
+     * FootprintTable that the footprint belongs to.
+     */
+    struct Footprint {
+        int orientation; ///< The index of the tile alternative
+        int x; ///< The column of the upper left corner of the bounding box
+        int y; ///< The row of the upper left corner of the bounding box
+        std::vector<int> marks; ///< The board squares covered by the tile, in row-major order
+        std::vector<int> around; ///< The board squares around the tile, in row-major order
+        const std::uint64_t* mark_bits; ///< The board squares covered by the tile as a bitboard
+        const std::uint64_t* around_bits; ///< The board squares around the tile as a bitboard
+    };
+
+    /** \brief All the legal footprints of a tile on a grid
+     *
+     * The bitboards of all footprints are stored in one cache-aligned block, with every bitboard starting on a
+     * cache line. A table can be moved, which keeps the bitboards in place, but not copied.
+     */
+    class FootprintTable {
+        int wh_; ///< The width and height of the grid
+        int words_; ///< Number of words in each bitboard
+        std::vector<Footprint> footprints_; ///< The footprints
+        std::vector<bitboard::Line> bits_; ///< Storage for the bitboards of the footprints
+        /// The footprint for each orientation and position, (orientation*wh_ + y)*wh_ + x, or -1 if not legal
+        std::vector<int> index_;
+    public:
+        /**
+         * Compute all the legal footprints for a tile.
+         *
+         * @param source The tile to compute the footprints for
+         * @param wh The width and height of the grid
+         */
+        FootprintTable(const TileSource& source, int wh);
+
+        FootprintTable(FootprintTable&&) noexcept = default;
+        FootprintTable(const FootprintTable&) = delete;
+        void operator=(const FootprintTable&) = delete;
+
+        /// Number of words in each bitboard
+        int words() const {
+            return words_;
+        }
+
+        /// Number of footprints
+        int size() const {
+            return static_cast<int>(footprints_.size());
+        }
+
+        bool empty() const {
+            return footprints_.empty();
+        }
+
+        const Footprint& operator[](int i) const {
+            return footprints_[i];
+        }
+
+        /**
+         * @param orientation The index of the tile alternative
+         * @param x The column of the upper left corner of the bounding box
+         * @param y The row of the upper left corner of the bounding box
+         * @return The index of the footprint, or -1 if there is no such legal footprint
+         */
+        int find(int orientation, int x, int y) const {
+            if (orientation < 0 || x < 0 || x >= wh_ || y < 0 || y >= wh_) {
+                return -1;
+            }
+            const int i = (orientation * wh_ + y) * wh_ + x;
+            return i < index_.size() ? index_[i] : -1;
+        }
+
+        std::vector<Footprint>::const_iterator begin() const {
+            return footprints_.begin();
+        }
+
+        std::vector<Footprint>::const_iterator end() const {
+            return footprints_.end();
+        }
+    };
+}
+
+#endif //NMBR9_FOOTPRINTS_H
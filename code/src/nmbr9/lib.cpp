@@ -5,13 +5,18 @@
 //
 
 #include "lib.h"
-#include "symmetry.h"
+#include "common.h"
+#include "connected.h"
+#include "footprint_branching.h"
+#include "placement.h"
+#include "stacking.h"
 #include "tiles.h"
 
 #include <gecode/driver.hh>
 #include <gecode/int.hh>
 #include <gecode/minimodel.hh>
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 
@@ -81,7 +86,8 @@ namespace nmbr9 {
     // Main code setting up the model.
     //
     
-    Nmbr9Board::Nmbr9Board(const Nmbr9Options& options)
+    Nmbr9Board::Nmbr9Board(const Nmbr9Options& options, const Layout& hint, const bool heuristics,
+                           const bool layout_symmetries)
             : IntMaximizeScript(options),
               instance_(options.instance()),
               wh_(options.grid_size()),
@@ -91,6 +97,17 @@ namespace nmbr9 {
               ncards_(options.deck_size()),
               nsquares_(wh_ * wh_),
               empty_color_(0),
+              placement_encoding_(options.placement_encoding()),
+              play_type_(options.play_type()),
+              seed_(options.seed()),
+              use_deck_level_symmetry_(options.use_deck_level_symmetry()),
+              lns_(options.lns()),
+              spiral_value_(options.spiral_value()),
+              placement_branching_(options.placement_branching()),
+              decay_(options.decay()),
+              rnd_(options.seed()),
+              solution_guided_(options.solution_guided()),
+              hint_(0), // Initialized in body
               boards_(), // Initialized in body
               value_boards_(), // Initialized in body
               tile_is_used_(*this, nparts_, 0, 1),
@@ -101,7 +118,6 @@ namespace nmbr9 {
               placement_boards_(), // Initialized in body
               part_boards_(), // Initialized in body
               around_boards_(), // Initialized in body
-              before_(*this, nparts_ * nparts_, 0, 1),
               deck_(*this, ncards_, 0, nparts_),
               order_(*this, nparts_, 0, nparts_),
               score_(*this, 0, options.max_value() * options.copies() * options.max_layers())
@@ -125,19 +141,20 @@ namespace nmbr9 {
             around_boards_.rbegin()->reserve(nparts_);
             for (int p = 0; p < nparts_; ++p) {
                 placement_boards_.rbegin()->emplace_back(IntVarArray(*this, nsquares_, 0, 2));
-                part_boards_.rbegin()->emplace_back(BoolVarArray(*this, nsquares_, 0, 1));
-                around_boards_.rbegin()->emplace_back(BoolVarArray(*this, nsquares_, 0, 1));
+                if (placement_encoding_ == PE_CHANNEL) {
+                    part_boards_.rbegin()->emplace_back(BoolVarArray(*this, nsquares_, 0, 1));
+                    around_boards_.rbegin()->emplace_back(BoolVarArray(*this, nsquares_, 0, 1));
+                }
             }
         }
         for (int p = 0; p < nparts_; ++p) {
-            tile_value_[p] = nmbr9::tile(options.instance(), p+1).value();
+            tile_value_[p] = nmbr9::tile_value(options.instance(), p+1);
         }
 
 
         // Setting upp access to variables
         //
 
-        Matrix<BoolVarArray> mbefore(before_, nparts_, nparts_);
         Matrix<BoolVarArray> mtile_is_on_level(tile_is_on_level_, nparts_, nlevels_);
 
 
@@ -174,15 +191,8 @@ namespace nmbr9 {
         // (2) Placement constraints
         for (int p = 0; p < nparts_; ++p) {
             const TileSource &tile_source = nmbr9::tile(options.instance(), p+1);
-            const REG &placement_expression = tile_source.as_placement_expression();
-            // Make placement expression reified with an additional first control variable
-            REG reified_placement =
-                    (REG(1) + // Placement for control variable
-                     placement_expression // Placement on board
-                    ) |
-                    (REG(0) + // No placement for control variable
-                     REG(0)(nsquares_, nsquares_) // No placement on board
-                    );
+            // The placement automaton is reified with an additional first control variable
+            const DFA &reified_placement = tile_source.placement_automaton();
             for (int l = 0; l < nlevels_; ++l) {
                 const IntVar tile_is_on_level = channel(*this, mtile_is_on_level(p, l));
                 const IntVarArgs reified_tile_variables = tile_is_on_level + placement_boards_[l][p];
@@ -202,19 +212,8 @@ namespace nmbr9 {
         }
         channel(*this, order_, extended_deck, options.ipl());
 
-        // (4, pt1) Order to before
-        for (int p1 = 0; p1 < nparts_; ++p1) {
-            for (int p2 = 0; p2 < nparts_; ++p2) {
-                if (p1 != p2) {
-                    rel(*this, order_[p1], IRT_LE, order_[p2], Reify(mbefore(p1, p2)));
-                }
-            }
-        }
-        for (int p = 0; p < nparts_; ++p) {
-            rel(*this, mbefore(p, p), IRT_EQ, 0);
-        }
-
-        // (4, pt2) Order to is placed
+        // (4) Order to is placed. The before relation B(p1, p2) of the paper is not represented explicitly,
+        // the connectedness and on top propagators work directly on the order.
         for (int p = 0; p < nparts_; ++p) {
             rel(*this, order_[p], IRT_LE, ncards_, Reify(tile_is_used_[p]));
         }
@@ -232,23 +231,34 @@ namespace nmbr9 {
             rel(*this, tile_is_used_[p], IRT_NQ, tile_is_not_used_[p]);
         }
 
-        // (7) Aspects of placement boards
-        for (int l = 0; l < nlevels_; ++l) {
-            for (int p = 0; p < nparts_; ++p) {
-                for (int s = 0; s < nsquares_; ++s) {
-                    channel(*this,
-                            BoolVarArgs{BoolVar(*this, 0, 1), part_boards_[l][p][s], around_boards_[l][p][s]},
-                            placement_boards_[l][p][s]);
+        if (placement_encoding_ == PE_CHANNEL) {
+            // (7) Aspects of placement boards
+            for (int l = 0; l < nlevels_; ++l) {
+                for (int p = 0; p < nparts_; ++p) {
+                    for (int s = 0; s < nsquares_; ++s) {
+                        channel(*this,
+                                BoolVarArgs{BoolVar(*this, 0, 1), part_boards_[l][p][s], around_boards_[l][p][s]},
+                                placement_boards_[l][p][s]);
+                    }
                 }
             }
-        }
 
-        // (8) Placement boards connected to actual boards
-        for (int l = 0; l < nlevels_; ++l) {
-            for (int p = 0; p < nparts_; ++p) {
-                for (int s = 0; s < nsquares_; ++s) {
-                    rel(*this, boards_[l][s], IRT_EQ, p+1, Reify(part_boards_[l][p][s]));
+            // (8) Placement boards connected to actual boards
+            for (int l = 0; l < nlevels_; ++l) {
+                for (int p = 0; p < nparts_; ++p) {
+                    for (int s = 0; s < nsquares_; ++s) {
+                        rel(*this, boards_[l][s], IRT_EQ, p+1, Reify(part_boards_[l][p][s]));
+                    }
+                }
+            }
+        } else {
+            // (7, 8) Placement boards connected directly to actual boards, without the Boolean aspects
+            for (int l = 0; l < nlevels_; ++l) {
+                IntVarArgs placements;
+                for (int p = 0; p < nparts_; ++p) {
+                    placements << IntVarArgs(placement_boards_[l][p]);
                 }
+                placement_channel(*this, boards_[l], placements);
             }
         }
 
@@ -256,7 +266,7 @@ namespace nmbr9 {
         IntArgs values;
         values << 0;
         for (int p = 1; p < ncolors_; ++p) {
-            values << nmbr9::tile(options.instance(), p).value();
+            values << nmbr9::tile_value(options.instance(), p);
         }
         for (int l = 0; l < nlevels_; ++l) {
             for (int s = 0; s < nsquares_; ++s) {
@@ -269,176 +279,44 @@ namespace nmbr9 {
         //
 
         // (9) Connectedness constraints
-        for (int p = 0; p < nparts_; ++p) {
-            for (int l = 0; l < nlevels_; ++l) {
-                // Guard (is on this level, is not first on level)
-                BoolVar guard(*this, 0, 1);
-                {
-                    BoolVar not_first(*this, 0, 1);
-                    BoolVarArgs is_before_and_on_level;
-
-                    for (int p2 = 0; p2 < nparts_; ++p2) {
-                        if (p2 != p) {
-                            BoolVar p2_before_and_on_level(*this, 0, 1);
-                            rel(*this, mbefore(p2, p), BOT_AND, mtile_is_on_level(p2, l), p2_before_and_on_level);
-                            is_before_and_on_level << p2_before_and_on_level;
-                        }
-                    }
-
-                    rel(*this, BOT_OR, is_before_and_on_level, not_first);
-                    rel(*this, mtile_is_on_level(p, l), BOT_AND, not_first, guard);
-                }
-
-                // Requirement (connected to another part)
-                BoolVar requirement(*this, 0, 1);
-                {
-                    BoolVarArgs connected_squares;
-                    for (int s = 0; s < nsquares_; ++s) {
-                        BoolVar before_part_placed_on_square(*this, 0, 1);
-                        {
-                            BoolVarArgs before_parts_placed_on_square;
-                            for (int p2 = 0; p2 < nparts_; ++p2) {
-                                if (p2 != p) {
-                                    before_parts_placed_on_square
-                                            << expr(*this, mbefore(p2, p) && part_boards_[l][p2][s]);
-                                }
-                            }
-                            rel(*this, BOT_OR, before_parts_placed_on_square, before_part_placed_on_square);
-                        }
-                        BoolVar square_is_connected(*this, 0, 1);
-                        rel(*this, before_part_placed_on_square, BOT_AND, around_boards_[l][p][s], square_is_connected);
-                        connected_squares << square_is_connected;
-                    }
-
-                    rel(*this, BOT_OR, connected_squares, requirement);
+        for (int l = 0; l < nlevels_; ++l) {
+            // If a part is on this level and is not the first part on this level, then there must exist a
+            // square that is around the part that is occupied by one of the parts before it on this level.
+            if (placement_encoding_ == PE_CHANNEL) {
+                BoolVarArgs around;
+                for (int p = 0; p < nparts_; ++p) {
+                    around << BoolVarArgs(around_boards_[l][p]);
                 }
-                // Actual constraint,
-                //   if there is a part placed before the current part on this level and
-                //   the current part is on this level,
-                // then
-                //   there must exist a square that is around the current part that is occupied by one of the
-                //   parts before this part on this level
-                rel(*this, guard >> requirement);
-            }
-        }
-
-        // (10) On top requirements
-        for (int l = 1; l < nlevels_; ++l) {
-            for (int p = 0; p < nparts_; ++p) {
-                for (int s = 0; s < nsquares_; ++s) {
-                    BoolVarArgs all_before_part_squares;
-                    for (int p2 = 0; p2 < nparts_; ++p2) {
-                        if (p2 != p) {
-                            BoolVar before_part_square(*this, 0, 1);
-                            rel(*this, mbefore(p2, p), BOT_AND, part_boards_[l - 1][p2][s], before_part_square);
-                            all_before_part_squares << before_part_square;
-                        }
-                    }
-                    BoolVar before_part_underneath(*this, 0, 1);
-                    rel(*this, BOT_OR, all_before_part_squares, before_part_underneath);
-                    //rel(*this, part_boards_[l][p][s], BOT_IMP, before_part_underneath, 1);
-                    rel(*this, part_boards_[l][p][s] >> before_part_underneath);
+                connected(*this, boards_[l], order_, mtile_is_on_level.row(l), around);
+            } else {
+                IntVarArgs placements;
+                for (int p = 0; p < nparts_; ++p) {
+                    placements << IntVarArgs(placement_boards_[l][p]);
                 }
+                connected(*this, boards_[l], order_, mtile_is_on_level.row(l), placements);
             }
         }
 
-        // (11) On top of at least two different parts
+        // (10, 11) On top requirements
         for (int l = 1; l < nlevels_; ++l) {
-            for (int p = 0; p < nparts_; ++p) {
-                // Guard (is on this level)
-                BoolVar guard = mtile_is_on_level(p, l);
-
-                // Requirement (sum of part type underneath is at least 2)
-                BoolVar requirement(*this, 0, 1);
-
-                BoolVarArgs is_on_top_of_part;
-                for (int p2 = 0; p2 < nparts_; ++p2) {
-                    if (p2 != p) {
-                        BoolVarArgs is_on_top_square;
-                        for (int s = 0; s < nsquares_; ++s) {
-                            is_on_top_square << expr(*this, part_boards_[l][p][s] && part_boards_[l-1][p2][s]);
-                        }
-                        BoolVar is_on_top(*this, 0, 1);
-                        rel(*this, BOT_OR, is_on_top_square, is_on_top);
-                        is_on_top_of_part << expr(*this, is_on_top && mbefore(p2, p));
-                    }
-                }
-                linear(*this, is_on_top_of_part, IRT_GQ, 2, Reify(requirement));
-
-                // Actual constraint,
-                //   If the part is on this level
-                // then
-                //   the number of parts it rests upon must be at least 2
-                rel(*this, guard, BOT_IMP, requirement, 1);
-            }
+            // Every square of a part on this level must rest on a part placed before it on the level below,
+            // and a part on this level must rest on at least two different parts.
+            stacking(*this, boards_[l], boards_[l-1], order_, mtile_is_on_level.row(l));
         }
 
 
         // Implied constraints
         //
 
-        // Each level needs two cards before the next level can be filled
-        for (int i = 0; i < ncards_; ++i) {
-            int max_level = (int) ceil(((double) i+1) / 2);
-            rel(*this, element(tile_level_, deck_[i]) <= max_level);
-        }
-
-        // Each layer must have at most the are of the previous layer
-        IntArgs tile_area;
-        for (int p = 0; p < nparts_; ++p) {
-            tile_area << nmbr9::tile(instance_, p+1).value();
-        }
-        IntVarArgs level_areas;
-        for (int l = 0; l < nlevels_; ++l) {
-            IntVar level_area(*this, 0, wh_*wh_);
-            linear(*this, tile_area, mtile_is_on_level.row(l), IRT_EQ, level_area);
-
-            level_areas << level_area;
-        }
-        for (int i = 0; i < level_areas.size() - 1; ++i) {
-            rel(*this, level_areas[i], IRT_GQ, level_areas[i+1]);
-        }
+        implied_levels(*this, instance_, boards_, tile_is_on_level_, deck_, tile_level_);
 
 
         // Symmetry breaking constraints
         //
 
-        // Copies of the same value can be fixed order in the deck
-        int copies = (int) options.copies();
-        for (int p = 0; p < nparts_; p += copies) {
-            IntArgs same_values;
-            for (int c = 0; c < copies; ++c) {
-                same_values << (p + c);
-            }
-            precede(*this, deck_, same_values);
-        }
+        break_symmetries(*this, options, boards_[0], deck_, tile_level_, layout_symmetries);
 
-        // Rotational symmetry on the base grid
 
-        // Type for tile vector<int> symmetry functions
-        typedef void (*varsymmfunc)(const IntVarArgs &, int, int, IntVarArgs &, int &, int &);
-        const std::vector<varsymmfunc> symmetries {
-                symmetry::rot90, symmetry::rot180, symmetry::rot270
-        };
-        for (const auto& symmetry : symmetries) {
-            IntVarArgs rotated_grid(nsquares_);
-            int gs = (int) options.grid_size();
-            symmetry(boards_[0], gs, gs, rotated_grid, gs, gs);
-            rel(*this, boards_[0], IRT_GQ, rotated_grid);
-        }
-
-        if (options.use_deck_level_symmetry()) {
-            // Symmetry breaking suggested by Ciaran McCreesh at CP2019
-            // When solving the free play type, we can decide that all the tiles on the bottom level are first in the deck.
-            // Unfortunately, this did not seem to help, even though it should.
-            if (options.play_type() == PT_FREE) {
-                for (int c = 0; c < ncards_ - 1; ++c) {
-                    rel(*this, element(tile_level_, deck_[c]) <= element(tile_level_, deck_[c + 1]));
-                }
-            }
-        }
-
-        
         // Calculate the score of the solution
         //
 
@@ -449,14 +327,66 @@ namespace nmbr9 {
         }
         linear(*this, tile_value_, tile_score_levels, IRT_EQ, score_);
 
+        // Upper bound on the score from the levels the parts can still reach
+        bound_score(*this, options, tile_level_, score_);
+
 
         // Set up heuristics
         //
 
-        if (options.play_type() == PT_KNOWN) {
+        // Hints for the heuristics from a layout: the part of each card, the level of each part, and the squares
+        // of each level in the order of the spiral branching. Parts and squares not in the layout are unused.
+        if (!hint.empty()) {
+            hint_ = IntSharedArray(ncards_ + nparts_ + nlevels_ * nsquares_);
+            for (int i = 0; i < hint_.size(); ++i) {
+                hint_[i] = i < ncards_ ? -1 : 0;
+            }
+            std::vector<IntArgs> square_hints(nlevels_, IntArgs::create(nsquares_, 0, 0));
+            for (int c = 0; c < hint.size() && c < ncards_; ++c) {
+                const Placement& placement = hint[c];
+                if (placement.part < 0 || placement.part >= nparts_ ||
+                    placement.level < 0 || placement.level >= nlevels_) {
+                    continue;
+                }
+                hint_[c] = placement.part;
+                hint_[ncards_ + placement.part] = placement.level + 1;
+                const FootprintTable& footprints = nmbr9::footprints(instance_, placement.part + 1);
+                const int index = footprints.find(placement.orientation, placement.x, placement.y);
+                if (index >= 0) {
+                    for (int s : footprints[index].marks) {
+                        square_hints[placement.level][s] = placement.part + 1;
+                    }
+                }
+            }
+            for (int l = 0; l < nlevels_; ++l) {
+                const IntArgs spiral = anti_spiral(square_hints[l], wh_);
+                for (int i = 0; i < nsquares_; ++i) {
+                    hint_[ncards_ + nparts_ + l * nsquares_ + i] = spiral[i];
+                }
+            }
+        }
+
+        // In a portfolio, each asset sets up its own heuristics when it starts
+        if (heuristics && options.assets() == 0) {
+            post_branching(0);
+        }
+    }
+
+
+    void Nmbr9Board::post_branching(const unsigned int asset) {
+        if (play_type_ == PT_KNOWN) {
             // A known deck is simulated by a random assignment.
             // Adjust the seed parameter to get different instances.
-            assign(*this, deck_, INT_ASSIGN_RND(Rnd(options.seed())));
+            assign(*this, deck_, INT_ASSIGN_RND(Rnd(seed_)));
+        }
+
+        // Assets in a portfolio differ in how the deck and levels are decided
+        const int configuration = static_cast<int>(asset % 4);
+
+        if (configuration == 3 && !use_deck_level_symmetry_ && play_type_ == PT_FREE) {
+            for (int c = 0; c < ncards_ - 1; ++c) {
+                rel(*this, element(tile_level_, deck_[c]) <= element(tile_level_, deck_[c + 1]));
+            }
         }
 
         // Use spiral pattern to get placements close to the center.
@@ -465,25 +395,97 @@ namespace nmbr9 {
             all_levels_bottom_to_top << anti_spiral(IntVarArgs(boards_[l]), wh_);
         }
 
+        // Value selection that prefers the hint for a variable, when there are hints and the hint is possible.
+        // With solution guidance the hints are only available after the first solution.
+        const bool use_hints = hint_.size() > 0 || solution_guided_;
+        const auto hinted = [](int offset, const IntBranchVal& fallback) {
+            return [offset, fallback](const Space& home, IntVar x, int i) {
+                const IntSharedArray& hints = static_cast<const Nmbr9Board&>(home).hint_;
+                if (hints.size() > 0) {
+                    const int hint = hints[offset + i];
+                    if (hint >= 0 && x.in(hint)) {
+                        return hint;
+                    }
+                }
+                return fallback(home, x, i);
+            };
+        };
+        const IntBranchVal smallest = [](const Space&, IntVar x, int) {
+            return x.min();
+        };
+        const IntBranchVal largest = [](const Space&, IntVar x, int) {
+            return x.max();
+        };
+
         // First, decide the cards and their order in the deck
-        branch(*this, deck_, INT_VAR_NONE(), INT_VAL_MIN());
-//        branch(*this, IntVarArgs(deck_.rbegin(), deck_.rend()), INT_VAR_NONE(), INT_VAL_MAX());
+        if (asset >= 4) {
+            // Assets beyond the basic configurations pick cards at random
+            branch(*this, deck_, INT_VAR_NONE(), INT_VAL_RND(Rnd(seed_ + asset)));
+        } else if (configuration == 1) {
+            branch(*this, IntVarArgs(deck_.rbegin(), deck_.rend()), INT_VAR_NONE(), INT_VAL_MAX());
+        } else if (use_hints) {
+            branch(*this, deck_, INT_VAR_NONE(), INT_VAL(hinted(0, smallest)));
+        } else {
+            branch(*this, deck_, INT_VAR_NONE(), INT_VAL_MIN());
+        }
+
+        // The learned heuristics break ties by the static order
+        const auto variable_selection = [&]() {
+            switch (placement_branching_) {
+                case PB_AFC:
+                    return INT_VAR_AFC_MAX(decay_);
+                case PB_ACTION:
+                    return INT_VAR_ACTION_MAX(decay_);
+                case PB_CHB:
+                    return INT_VAR_CHB_MAX();
+                case PB_SPIRAL:
+                case PB_FOOTPRINT:
+                default:
+                    return INT_VAR_NONE();
+            }
+        };
 
         // Then, decide the level for the different cards.
         // This uniquely determines the score.
-        branch(*this, tile_level_, INT_VAR_NONE(), INT_VAL_MAX());
-
-        // Find placements for the parts
-        branch(*this, all_levels_bottom_to_top, INT_VAR_NONE(),
-                INT_VAL([](const Space& home, IntVar x, int i){
-                    // Choose the minimum part value. That is, a value that is not empty (0).
-                    if (x.min() > 0) {
-                        return x.min();
-                    }
-                    IntVarValues values(x);
+        if (use_hints) {
+            branch(*this, tile_level_, variable_selection(),
+                   INT_VAL(hinted(ncards_, configuration == 2 ? smallest : largest)));
+        } else if (configuration == 2) {
+            branch(*this, tile_level_, variable_selection(), INT_VAL_MIN());
+        } else {
+            branch(*this, tile_level_, variable_selection(), INT_VAL_MAX());
+        }
+
+        // Find placements for the parts, either as whole footprints or square by square
+        if (placement_branching_ == PB_FOOTPRINT) {
+            branch_footprints(*this, instance_, boards_, deck_, tile_level_);
+        }
+        IntBranchVal spiral_value;
+        if (spiral_value_ == SV_RANDOM) {
+            spiral_value = [](const Space& home, IntVar x, int i){
+                // Choose a random part value. That is, a value that is not empty (0).
+                const int empty = x.min() > 0 ? 0 : 1;
+                Rnd rnd = static_cast<const Nmbr9Board&>(home).rnd_;
+                const int skip = empty + static_cast<int>(rnd(x.size() - empty));
+                IntVarValues values(x);
+                for (int v = 0; v < skip; ++v) {
                     ++values;
-                    return values.val();
-                }));
+                }
+                return values.val();
+            };
+        } else {
+            spiral_value = [](const Space& home, IntVar x, int i){
+                // Choose the minimum part value. That is, a value that is not empty (0).
+                if (x.min() > 0) {
+                    return x.min();
+                }
+                IntVarValues values(x);
+                ++values;
+                return values.val();
+            };
+        }
+        branch(*this, all_levels_bottom_to_top, variable_selection(),
+               INT_VAL(use_hints ? IntBranchVal(hinted(ncards_ + nparts_, spiral_value)) : spiral_value));
 
         // Assign the order variables (is the deck does not contain all parts,
         // some are left undetermined by above branchings).
@@ -491,16 +493,52 @@ namespace nmbr9 {
     }
 
 
+    void Nmbr9Board::constrain(const Space& best) {
+        IntMaximizeScript::constrain(best);
+        if (!solution_guided_) {
+            return;
+        }
+
+        // Replace the hints by the solution, in the same layout as for hints from a layout
+        const auto& solution = static_cast<const Nmbr9Board&>(best);
+        IntSharedArray hint(ncards_ + nparts_ + nlevels_ * nsquares_);
+        for (int c = 0; c < ncards_; ++c) {
+            hint[c] = solution.deck_[c].val();
+        }
+        for (int p = 0; p < nparts_; ++p) {
+            hint[ncards_ + p] = solution.tile_level_[p].val();
+        }
+        for (int l = 0; l < nlevels_; ++l) {
+            const IntVarArgs spiral = anti_spiral(IntVarArgs(solution.boards_[l]), wh_);
+            for (int i = 0; i < nsquares_; ++i) {
+                hint[ncards_ + nparts_ + l * nsquares_ + i] = spiral[i].val();
+            }
+        }
+        hint_ = hint;
+    }
+
+
     Nmbr9Board::Nmbr9Board(Nmbr9Board &s) :
             IntMaximizeScript(s), instance_(s.instance_), wh_(s.wh_), nlevels_(s.nlevels_),
             nparts_(s.nparts_), ncolors_(s.ncolors_), ncards_(s.ncards_), nsquares_(s.nsquares_),
             empty_color_(s.empty_color_),
+            placement_encoding_(s.placement_encoding_),
+            play_type_(s.play_type_),
+            seed_(s.seed_),
+            use_deck_level_symmetry_(s.use_deck_level_symmetry_),
+            lns_(s.lns_),
+            spiral_value_(s.spiral_value_),
+            placement_branching_(s.placement_branching_),
+            decay_(s.decay_),
+            rnd_(s.rnd_),
+            solution_guided_(s.solution_guided_),
+            hint_(s.hint_),
             boards_(nlevels_, IntVarArray()),
             value_boards_(nlevels_, IntVarArray()),
             tile_value_(s.tile_value_),
             placement_boards_(nlevels_, std::vector(nparts_, IntVarArray())),
-            part_boards_(nlevels_, std::vector(nparts_, BoolVarArray())),
-            around_boards_(nlevels_, std::vector(nparts_, BoolVarArray()))
+            part_boards_(nlevels_, std::vector<BoolVarArray>()),
+            around_boards_(nlevels_, std::vector<BoolVarArray>())
 
     {
         for (int l = 0; l < nlevels_; ++l) {
@@ -508,8 +546,14 @@ namespace nmbr9 {
             value_boards_[l].update(*this, s.value_boards_[l]);
             for (int p = 0; p < nparts_; ++p) {
                 placement_boards_[l][p].update(*this, s.placement_boards_[l][p]);
-                part_boards_[l][p].update(*this, s.part_boards_[l][p]);
-                around_boards_[l][p].update(*this, s.around_boards_[l][p]);
+            }
+            if (placement_encoding_ == PE_CHANNEL) {
+                part_boards_[l].resize(nparts_);
+                around_boards_[l].resize(nparts_);
+                for (int p = 0; p < nparts_; ++p) {
+                    part_boards_[l][p].update(*this, s.part_boards_[l][p]);
+                    around_boards_[l][p].update(*this, s.around_boards_[l][p]);
+                }
             }
         }
 
@@ -517,7 +561,6 @@ namespace nmbr9 {
         tile_is_not_used_.update(*this, s.tile_is_not_used_);
         tile_is_on_level_.update(*this, s.tile_is_on_level_);
         tile_level_.update(*this, s.tile_level_);
-        before_.update(*this, s.before_);
         deck_.update(*this, s.deck_);
         order_.update(*this, s.order_);
         score_.update(*this, s.score_);
@@ -527,6 +570,76 @@ namespace nmbr9 {
         return new Nmbr9Board(*this);
     }
 
+    bool Nmbr9Board::slave(const MetaInfo& mi) {
+        if (mi.type() == MetaInfo::PORTFOLIO) {
+            post_branching(mi.asset());
+        } else if (mi.type() == MetaInfo::RESTART && lns_ > 0.0 && mi.last() != nullptr) {
+            relax(static_cast<const Nmbr9Board&>(*mi.last()), mi.restart());
+            // Only a neighbourhood is searched, so the search is not complete
+            return false;
+        }
+        return true;
+    }
+
+    void Nmbr9Board::post_heuristics(const unsigned int seed) {
+        seed_ = seed;
+        rnd_ = Rnd(seed);
+        post_branching(0);
+    }
+
+    void Nmbr9Board::reveal(const int card, const int p) {
+        rel(*this, deck_[card], IRT_EQ, p);
+    }
+
+    void Nmbr9Board::keep_part(const Nmbr9Board& last, const int p) {
+        const int level = last.tile_level_[p].val();
+        rel(*this, tile_level_[p], IRT_EQ, level);
+        if (level == 0) {
+            return;
+        }
+        rel(*this, order_[p], IRT_EQ, last.order_[p].val());
+        const IntVarArray& last_board = last.boards_[level - 1];
+        for (int s = 0; s < nsquares_; ++s) {
+            if (last_board[s].val() == p + 1) {
+                rel(*this, boards_[level - 1][s], IRT_EQ, p + 1);
+            }
+        }
+    }
+
+    void Nmbr9Board::relax(const Nmbr9Board& last, const unsigned long int restart) {
+        // Random numbers in [0, 1) with enough precision for the probabilities
+        const unsigned int resolution = 1u << 20u;
+        const auto random_probability = [&] {
+            return static_cast<double>(rnd_(resolution)) / resolution;
+        };
+
+        if (play_type_ == PT_KNOWN) {
+            // The known deck is part of the instance, a neighbour on another deck is not a better solution
+            for (int c = 0; c < ncards_; ++c) {
+                rel(*this, deck_[c], IRT_EQ, last.deck_[c].val());
+            }
+        }
+
+        if (restart % 2 == 0) {
+            for (int p = 0; p < nparts_; ++p) {
+                if (random_probability() >= lns_) {
+                    keep_part(last, p);
+                }
+            }
+        } else {
+            // A prefix with on average (1 - lns_) * ncards_ cards
+            const double fraction = 2 * (1.0 - lns_) * random_probability();
+            const int prefix = std::min(ncards_, static_cast<int>(fraction * ncards_));
+            for (int c = 0; c < prefix; ++c) {
+                const int p = last.deck_[c].val();
+                rel(*this, deck_[c], IRT_EQ, p);
+                if (p < nparts_) {
+                    keep_part(last, p);
+                }
+            }
+        }
+    }
+
 
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "OCSimplifyInspection"
@@ -544,7 +657,7 @@ namespace nmbr9 {
                     for (int p = 0; p < nparts_; ++p) {
                         os << "  |  ";
                         for (int w = 0; w < wh_; ++w) {
-                            print_square_part_board(os, part_boards_[l][p][h * wh_ + w]);
+                            print_square_part_board(os, placement_boards_[l][p][h * wh_ + w]);
                         }
                     }
                 }
@@ -563,7 +676,7 @@ namespace nmbr9 {
         os << "Part values: {";
         for (int i = 0; i < deck_.size(); ++i) {
             if (deck_[i].assigned()) {
-                os << std::setw(2) << nmbr9::tile(instance_, deck_[i].val()+1).value();
+                os << std::setw(2) << nmbr9::tile_value(instance_, deck_[i].val()+1);
             } else {
                 os << " ?";
             }
@@ -576,6 +689,13 @@ namespace nmbr9 {
         os << "Tiles used : " << tile_is_used_ << std::endl;
         os << "Tiles levels : " << tile_level_ << std::endl;
         os << "Score : " << score_ << std::endl;
+        bool assigned = deck_.assigned() && tile_level_.assigned();
+        for (int l = 0; l < nlevels_ && assigned; ++l) {
+            assigned = boards_[l].assigned();
+        }
+        if (assigned) {
+            os << "Layout : " << layout() << std::endl;
+        }
     }
 #pragma clang diagnostic pop
 
@@ -583,6 +703,41 @@ namespace nmbr9 {
         return score_;
     }
 
+    Layout Nmbr9Board::layout() const {
+        Layout result;
+        std::vector<int> marks;
+        for (int i = 0; i < ncards_; ++i) {
+            const int p = deck_[i].val();
+            if (p >= nparts_) {
+                continue;
+            }
+            const int level = tile_level_[p].val() - 1;
+
+            // The bounding box of a footprint is the bounding box of the part with the squares around it
+            marks.clear();
+            int min_x = wh_, min_y = wh_;
+            for (int s = 0; s < nsquares_; ++s) {
+                if (boards_[level][s].val() == p + 1) {
+                    marks.emplace_back(s);
+                    min_x = std::min(min_x, s % wh_);
+                    min_y = std::min(min_y, s / wh_);
+                }
+            }
+            Placement placement{p, level, min_x - 1, min_y - 1, -1};
+            const FootprintTable& footprints = nmbr9::footprints(instance_, p + 1);
+            const int orientations = static_cast<int>(nmbr9::tile(instance_, p + 1).alternatives().size());
+            for (int orientation = 0; orientation < orientations; ++orientation) {
+                const int index = footprints.find(orientation, placement.x, placement.y);
+                if (index >= 0 && footprints[index].marks == marks) {
+                    placement.orientation = orientation;
+                    break;
+                }
+            }
+            result.emplace_back(placement);
+        }
+        return result;
+    }
+
 #pragma clang diagnostic push
 #pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
     void print_square_part_board(std::ostream &os, const IntVar &square) {
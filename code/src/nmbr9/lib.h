@@ -10,6 +10,7 @@
 
 #include "tiles.h"
 #include "base.h"
+#include "verify.h"
 
 #include <gecode/driver.hh>
 #include <gecode/int.hh>
@@ -17,6 +18,8 @@
 #include <vector>
 #include <cassert>
 #include <optional>
+#include <sstream>
+#include <string>
 
 namespace nmbr9 {
         class Nmbr9Options : public Gecode::Options {
@@ -30,6 +33,32 @@ namespace nmbr9 {
         Gecode::Driver::UnsignedIntOption max_layers_;
 
         Gecode::Driver::BoolOption use_deck_level_symmetry_;
+
+        Gecode::Driver::StringOption placement_encoding_;
+
+        Gecode::Driver::StringOption model_;
+
+        Gecode::Driver::StringOption engine_;
+
+        Gecode::Driver::DoubleOption lns_;
+
+        Gecode::Driver::StringOption spiral_value_;
+
+        Gecode::Driver::StringOption placement_branching_;
+
+        Gecode::Driver::BoolOption use_score_bound_;
+
+        Gecode::Driver::BoolOption use_translation_symmetry_;
+
+        Gecode::Driver::BoolOption solution_guided_;
+
+        Gecode::Driver::UnsignedIntOption card_time_;
+
+        Gecode::Driver::UnsignedIntOption samples_;
+
+        Gecode::Driver::StringOption output_;
+
+        Gecode::Driver::StringOption grid_stop_;
     public:
         Nmbr9Options()
         : Options("Nmbr9"),
@@ -41,7 +70,26 @@ namespace nmbr9 {
           grid_size_("grid-size", "the size of the grid, default 20", 20),
           max_layers_("max-layers", "the maximum layer to use, default 7", 7),
           use_deck_level_symmetry_("deck-level-symmetry",
-                  "When true and in free play type, force the levels of cards in deck to be ordered.", false)
+                  "When true and in free play type, force the levels of cards in deck to be ordered.", false),
+          placement_encoding_("placement-encoding", "encoding of the placement boards, default is channel", PE_CHANNEL),
+          model_("model", "model to use, default is board", MT_BOARD),
+          engine_("engine", "what to run, default is script", ET_SCRIPT),
+          lns_("lns", "with restarts, the probability to free each part of the last solution, default 0 (off)", 0.0),
+          spiral_value_("spiral-value", "part to place on the squares in spiral order, default is min", SV_MIN),
+          placement_branching_("placement-branching",
+                  "order to decide the levels and squares in, default is spiral", PB_SPIRAL),
+          use_score_bound_("score-bound",
+                  "When true, bound the score by the largest values of the parts that may reach each level.", true),
+          use_translation_symmetry_("translation-symmetry",
+                  "When true, center the parts on the bottom level to break translation symmetry.", false),
+          solution_guided_("solution-guided",
+                  "When true, the heuristics first try the values of the best solution so far.", false),
+          card_time_("card-time", "with the stream engine, the search time in ms per card, 0 for no limit, default 100",
+                  100),
+          samples_("samples", "with the evaluate engine, the number of random decks to play, default 1000", 1000),
+          output_("output", "format of the results of the script engine, default is text", OF_TEXT),
+          grid_stop_("grid-stop", "with the auto-grid engine, when to stop growing the grid, default is plateau",
+                  GS_PLATEAU)
         {
             add(play_type_);
             add(max_value_);
@@ -53,26 +101,122 @@ namespace nmbr9 {
 
             add(use_deck_level_symmetry_);
 
+            add(placement_encoding_);
+
+            add(model_);
+
+            add(engine_);
+
+            add(lns_);
+
+            add(spiral_value_);
+
+            add(placement_branching_);
+
+            add(use_score_bound_);
+
+            add(use_translation_symmetry_);
+
+            add(solution_guided_);
+
+            add(card_time_);
+
+            add(samples_);
+
+            add(output_);
+
+            add(grid_stop_);
+
             play_type_.add(PT_FREE, "free");
             play_type_.add(PT_KNOWN, "known");
+
+            placement_encoding_.add(PE_CHANNEL, "channel",
+                    "placement boards channeled to Boolean part and around boards");
+            placement_encoding_.add(PE_COMPACT, "compact",
+                    "only placement boards, connected directly to the level boards");
+
+            model_.add(MT_BOARD, "board", "placement boards with regular constraints");
+            model_.add(MT_ANCHOR, "anchor", "anchors into precomputed footprints");
+
+            engine_.add(ET_SCRIPT, "script", "search for the best layout");
+            engine_.add(ET_VERIFY, "verify", "verify layouts from standard input, one per line");
+            engine_.add(ET_AUTO_GRID, "auto-grid", "search on growing grids, from the smallest possible grid");
+            engine_.add(ET_DEEPENING, "deepening", "search with growing numbers of layers, from 2 layers");
+            engine_.add(ET_STREAM, "stream", "play the card values on standard input as they are revealed");
+            engine_.add(ET_EVALUATE, "evaluate", "estimate the expected score of streaming play over random decks");
+            engine_.add(ET_BATCH, "batch", "run the jobs on standard input, one line of options per job");
+
+            spiral_value_.add(SV_MIN, "min", "the part with the smallest number");
+            spiral_value_.add(SV_RANDOM, "random", "a random part, for diversity between restarts");
+
+            placement_branching_.add(PB_SPIRAL, "spiral", "squares in spiral order from the center");
+            placement_branching_.add(PB_AFC, "afc", "largest accumulated failure count first, using -decay");
+            placement_branching_.add(PB_ACTION, "action", "largest action first, using -decay");
+            placement_branching_.add(PB_CHB, "chb", "largest conflict history first");
+            placement_branching_.add(PB_FOOTPRINT, "footprint", "whole footprints for the parts in deck order");
+
+            output_.add(OF_TEXT, "text", "the boards of the solutions as text");
+            output_.add(OF_JSONL, "jsonl", "one JSON object per line for each improving solution");
+
+            grid_stop_.add(GS_BOUND, "bound", "when the best score reaches the upper bound, exact but usually all grids");
+            grid_stop_.add(GS_FEASIBLE, "feasible", "at the first grid with a layout");
+            grid_stop_.add(GS_PLATEAU, "plateau", "at the first larger grid without a better layout");
         }
 
 
+        /// Parse the options, and exit with a message if they are not valid, see validate
         void parse(int& argc, char* argv[]) {
             Options::parse(argc, argv);
-            if (max_value_.value() > 9) {
-                std::cerr << "max-value can be at most 9, " << max_value_.value()
-                          << " supplied." << std::endl;
+            const std::string error = validate();
+            if (!error.empty()) {
+                std::cerr << error << std::endl;
                 std::exit(EXIT_FAILURE);
             }
+        }
+
+        /**
+         * Check that the parsed options can be used together, and compute the number of parts.
+         *
+         * @return A description of the first problem found, or an empty string if the options are valid
+         */
+        std::string validate() {
+            std::ostringstream error;
+            if (max_value_.value() > 9) {
+                error << "max-value can be at most 9, " << max_value_.value() << " supplied.";
+                return error.str();
+            }
+            if (lns_.value() < 0.0 || lns_.value() > 1.0) {
+                error << "lns must be between 0 and 1, " << lns_.value() << " supplied.";
+                return error.str();
+            }
+            if (model() == MT_ANCHOR && assets() > 0) {
+                return "assets is only supported by the board model, the anchor model has no portfolio.";
+            }
+            if (engine() != ET_SCRIPT && engine() != ET_VERIFY) {
+                if (model() != MT_BOARD) {
+                    return "the anchor model is only supported by the script engine.";
+                }
+                if (assets() > 0) {
+                    return "assets is only supported by the script engine.";
+                }
+            }
+            if (output() == OF_JSONL && (assets() > 0 || restart() != Gecode::RM_NONE || lns() > 0)) {
+                return "output jsonl only supports branch and bound, without assets, restart, or lns.";
+            }
+            if ((engine() == ET_STREAM || engine() == ET_EVALUATE) &&
+                (use_translation_symmetry() || use_deck_level_symmetry())) {
+                return "translation-symmetry and deck-level-symmetry remove legal placements "
+                       "when the cards are played as they are revealed.";
+            }
             number_of_parts_ = (max_value_.value()+1) * copies_.value();
             if (number_of_parts_ < deck_size_.value()) {
-                std::cerr << "deck-size can be at most max-value*copies (("
-                          << max_value_.value() << "+1)*" << copies_.value() << "="
-                          << ((max_value_.value()+1) * copies_.value()) << "), "
-                          << deck_size_.value() << " supplied." << std::endl;
-                std::exit(EXIT_FAILURE);
+                error << "deck-size can be at most max-value*copies (("
+                      << max_value_.value() << "+1)*" << copies_.value() << "="
+                      << ((max_value_.value()+1) * copies_.value()) << "), "
+                      << deck_size_.value() << " supplied.";
+                return error.str();
             }
+            return "";
         }
 
         [[nodiscard]] PlayType play_type() const {
@@ -99,15 +243,88 @@ namespace nmbr9 {
             return static_cast<int>(grid_size_.value());
         }
 
+        /// Change the grid size, for engines that try several grids
+        void grid_size(int wh) {
+            grid_size_.value(static_cast<unsigned int>(wh));
+        }
+
         [[nodiscard]] int max_layers() const {
             return static_cast<int>(max_layers_.value());
         }
 
+        /// Change the maximum number of layers, for engines that try several depths
+        void max_layers(int layers) {
+            max_layers_.value(static_cast<unsigned int>(layers));
+        }
+
         [[nodiscard]] bool use_deck_level_symmetry() const {
             return static_cast<int>(use_deck_level_symmetry_.value());
         }
 
 
+        [[nodiscard]] PlacementEncoding placement_encoding() const {
+            return static_cast<const PlacementEncoding>(placement_encoding_.value());
+        }
+
+
+        [[nodiscard]] ModelType model() const {
+            return static_cast<const ModelType>(model_.value());
+        }
+
+
+        [[nodiscard]] EngineType engine() const {
+            return static_cast<const EngineType>(engine_.value());
+        }
+
+        [[nodiscard]] OutputFormat output() const {
+            return static_cast<const OutputFormat>(output_.value());
+        }
+
+        [[nodiscard]] GridStop grid_stop() const {
+            return static_cast<const GridStop>(grid_stop_.value());
+        }
+
+
+        [[nodiscard]] SpiralValue spiral_value() const {
+            return static_cast<const SpiralValue>(spiral_value_.value());
+        }
+
+
+        [[nodiscard]] PlacementBranching placement_branching() const {
+            return static_cast<const PlacementBranching>(placement_branching_.value());
+        }
+
+
+        [[nodiscard]] bool use_translation_symmetry() const {
+            return use_translation_symmetry_.value();
+        }
+
+
+        [[nodiscard]] bool use_score_bound() const {
+            return use_score_bound_.value();
+        }
+
+
+        [[nodiscard]] bool solution_guided() const {
+            return solution_guided_.value();
+        }
+
+
+        [[nodiscard]] unsigned int card_time() const {
+            return card_time_.value();
+        }
+
+
+        [[nodiscard]] unsigned int samples() const {
+            return samples_.value();
+        }
+
+
+        [[nodiscard]] double lns() const {
+            return lns_.value();
+        }
+
+
         [[nodiscard]] Instance instance() const {
             return Instance(play_type(), max_value(), copies(), deck_size(), grid_size());
         }
@@ -132,6 +349,29 @@ namespace nmbr9 {
         const int nsquares_;
         /// The value for empty squares
         const int empty_color_;
+        /// The encoding used for the placement boards
+        const PlacementEncoding placement_encoding_;
+        /// The play type, used when setting up the heuristics
+        const PlayType play_type_;
+        /// The seed for random heuristics
+        unsigned int seed_;
+        /// Whether the deck-level symmetry breaking is used
+        const bool use_deck_level_symmetry_;
+        /// The probability to free a part when relaxing a solution, 0 for no large neighbourhood search
+        const double lns_;
+        /// The part to place on the squares in spiral order
+        const SpiralValue spiral_value_;
+        /// The order to decide the levels and squares in
+        const PlacementBranching placement_branching_;
+        /// The decay for the learned heuristics
+        const double decay_;
+        /// Random numbers for choosing the neighbourhoods and for the random spiral value
+        Gecode::Rnd rnd_;
+        /// Whether the hints are replaced by each better solution found
+        const bool solution_guided_;
+        /// Hinted values for the deck, the levels, and the squares in spiral order, -1 for no hint. Empty if the
+        /// heuristics have no hints.
+        Gecode::IntSharedArray hint_;
 
         /// The variables for the board. (boards[l] is G_l)
         std::vector<Gecode::IntVarArray> boards_;
@@ -159,14 +399,13 @@ namespace nmbr9 {
         std::vector<std::vector<Gecode::IntVarArray>> placement_boards_;
 
         /// Boolean variables representing placement of different tiles. (placement_boards_[l][p] is G_pl^1)
+        /// Empty for the compact placement encoding.
         std::vector<std::vector<Gecode::BoolVarArray>> part_boards_;
 
         /// Boolean variables representing surrounding area of different tiles. (placement_boards_[l][p] is G_pl^2)
+        /// Empty for the compact placement encoding.
         std::vector<std::vector<Gecode::BoolVarArray>> around_boards_;
 
-        /// Boolean variables representing the before relation (matrix(before_, nparts_, nparts_)(p1, p2) is B(p1, p2))
-        Gecode::BoolVarArray before_;
-
         /// The deck of cards. (deck_[i] is D(i))
         Gecode::IntVarArray deck_;
 
@@ -176,9 +415,38 @@ namespace nmbr9 {
         /// The score of the solution (score_ is S)
         Gecode::IntVar score_;
 
+        /**
+         * Post the heuristics for the search.
+         *
+         * Asset 0 uses the standard heuristics. Assets 1 to 3 instead decide the deck from the end with the
+         * largest parts first, decide the lowest levels first, and break the deck-level symmetry. Further assets
+         * choose the cards in the deck at random.
+         *
+         * @param asset The asset in a portfolio, 0 when not using a portfolio
+         */
+        void post_branching(unsigned int asset);
+
+        /**
+         * Relax the solution \a last for large neighbourhood search.
+         *
+         * Alternates between keeping a random subset of the parts, and keeping a prefix of the deck, where the
+         * size of the prefix is random. In both cases a part is freed with probability lns_ on average. With the
+         * known play type, the whole deck of the last solution is always kept.
+         */
+        void relax(const Nmbr9Board& last, unsigned long int restart);
+
     public:
-        /// Construction of the model.
-        explicit Nmbr9Board(const Nmbr9Options& opts);
+        /**
+         * Construction of the model.
+         *
+         * @param opts The options for the model
+         * @param hint A layout that the heuristics try first, for example the best layout of an earlier run
+         * @param heuristics False to leave out the heuristics, which are then posted with post_heuristics
+         * @param layout_symmetries False to only break the symmetry between copies, for a model where some cards
+         *        are placed before the rest of the layout is known
+         */
+        explicit Nmbr9Board(const Nmbr9Options& opts, const Layout& hint = Layout(), bool heuristics = true,
+                            bool layout_symmetries = true);
 
         /// Constructor for cloning \a s
         Nmbr9Board(Nmbr9Board &s);
@@ -186,10 +454,41 @@ namespace nmbr9 {
         /// Copy space during cloning
         Nmbr9Board *copy() override;
 
+        /// Set up the heuristics for an asset in a portfolio, and relax the last solution after a restart
+        bool slave(const Gecode::MetaInfo& mi) override;
+
+        /**
+         * Post the heuristics with a new seed, in a model constructed without heuristics.
+         *
+         * This makes it possible to construct the model once and search clones of it with different seeds.
+         */
+        void post_heuristics(unsigned int seed);
+
+        /**
+         * Fix card \a card in the deck to part \a p, for playing with cards that are revealed one at a time.
+         */
+        void reveal(int card, int p);
+
+        /**
+         * Fix a part to its placement in \a last.
+         *
+         * The level, the order, and the squares of the part are kept. A part that is not used stays unused.
+         */
+        void keep_part(const Nmbr9Board& last, int p);
+
+        /// Require a better score than \a best, and with solution guidance use \a best as the new hint
+        void constrain(const Gecode::Space& best) override;
+
         /// Print solution
         void print(std::ostream &os) const override;
 
         Gecode::IntVar cost() const override;
+
+        /**
+         * Extract the placements of a solution, for checking with a Verifier.
+         * All the boards, the deck, and the levels must be assigned.
+         */
+        Layout layout() const;
     };
 
     /**
@@ -0,0 +1,68 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "output.h"
+#include "tiles.h"
+
+#include <sys/resource.h>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    long peak_memory() {
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+#ifdef __APPLE__
+        // In bytes on macOS, in kilobytes elsewhere
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+
+    SolutionWriter::SolutionWriter(std::ostream& os, const Instance instance)
+            : os_(os), instance_(instance), start_(std::chrono::steady_clock::now()) {
+    }
+
+    void SolutionWriter::write_statistics(const Search::Statistics& statistics) {
+        const std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start_;
+        os_ << "\"time\":" << time.count()
+            << ",\"nodes\":" << statistics.node
+            << ",\"failures\":" << statistics.fail
+            << ",\"propagations\":" << statistics.propagate
+            << ",\"depth\":" << statistics.depth
+            << ",\"peak_memory\":" << peak_memory();
+    }
+
+    void SolutionWriter::solution(const int score, const Layout& layout, const Search::Statistics& statistics) {
+        os_ << "{\"type\":\"solution\",\"score\":" << score << ",";
+        write_statistics(statistics);
+
+        os_ << ",\"deck\":[";
+        for (int i = 0; i < layout.size(); ++i) {
+            os_ << (i > 0 ? "," : "") << tile_value(instance_, layout[i].part + 1);
+        }
+        os_ << "],\"placements\":[";
+        for (int i = 0; i < layout.size(); ++i) {
+            const Placement& placement = layout[i];
+            os_ << (i > 0 ? "," : "")
+                << "{\"part\":" << placement.part
+                << ",\"level\":" << placement.level
+                << ",\"x\":" << placement.x
+                << ",\"y\":" << placement.y
+                << ",\"orientation\":" << placement.orientation << "}";
+        }
+        os_ << "]}" << std::endl;
+    }
+
+    void SolutionWriter::end(const int best_score, const bool complete, const Search::Statistics& statistics) {
+        os_ << "{\"type\":\"end\",\"score\":" << best_score
+            << ",\"complete\":" << (complete ? "true" : "false") << ",";
+        write_statistics(statistics);
+        os_ << "}" << std::endl;
+    }
+}
@@ -0,0 +1,94 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_OUTPUT_H
+#define NMBR9_OUTPUT_H
+
+#include "lib.h"
+#include "verify.h"
+
+#include <gecode/search.hh>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <ostream>
+
+namespace nmbr9 {
+
+    /// The peak resident memory of the process in kilobytes, or 0 if not known
+    long peak_memory();
+
+    /**
+     * Writes the improving solutions of a search as JSON Lines, for plotting the score over time.
+     *
+     * Each solution is an object with "type" set to "solution", the score, the time in milliseconds since the
+     * writer was created, the search statistics so far, the peak memory of the process in kilobytes, the values
+     * of the cards in the deck, and the placements in deck order. The end of the search is an object with "type"
+     * set to "end", with the best score, whether the search was complete, and the same statistics.
+     */
+    class SolutionWriter {
+        /// The stream to write to
+        std::ostream& os_;
+        /// The instance of the solutions, for the values of the parts
+        const Instance instance_;
+        /// The time the search started
+        const std::chrono::steady_clock::time_point start_;
+
+        /// Write the time, the statistics, and the memory as members of an object
+        void write_statistics(const Gecode::Search::Statistics& statistics);
+    public:
+        SolutionWriter(std::ostream& os, Instance instance);
+
+        /// Write a solution with the statistics of the search so far
+        void solution(int score, const Layout& layout, const Gecode::Search::Statistics& statistics);
+
+        /// Write the end of the search
+        void end(int best_score, bool complete, const Gecode::Search::Statistics& statistics);
+    };
+
+    /**
+     * Search for the best layout with branch and bound, and write each improving solution with a SolutionWriter
+     * to standard output.
+     *
+     * Uses the threads, the time limit, and the number of solutions in the options, where 0 solutions means
+     * searching until the best layout is proven. The options that need the search of the Gecode driver, which are
+     * a portfolio, restarts, and large neighbourhood search, are rejected when the options are parsed.
+     *
+     * @tparam Model The model to search with, must have a layout() of its solutions
+     * @return The best score found, or -1 if there is none
+     */
+    template<class Model>
+    int run_jsonl(const Nmbr9Options& opt) {
+        SolutionWriter writer(std::cout, opt.instance());
+        auto* model = new Model(opt);
+
+        Gecode::Search::Options so;
+        so.threads = opt.threads();
+        std::unique_ptr<Gecode::Search::Stop> stop;
+        if (opt.time() > 0) {
+            stop = std::make_unique<Gecode::Search::TimeStop>(opt.time());
+            so.stop = stop.get();
+        }
+        Gecode::BAB<Model> engine(model, so);
+        delete model;
+
+        int best_score = -1;
+        bool complete = true;
+        unsigned int found = 0;
+        while (Model* solution = engine.next()) {
+            best_score = solution->cost().val();
+            writer.solution(best_score, solution->layout(), engine.statistics());
+            delete solution;
+            if (++found == opt.solutions()) {
+                complete = false;
+                break;
+            }
+        }
+        writer.end(best_score, complete && !engine.stopped(), engine.statistics());
+        return best_score;
+    }
+}
+
+#endif //NMBR9_OUTPUT_H
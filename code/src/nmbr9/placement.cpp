@@ -0,0 +1,178 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "placement.h"
+
+#include <gecode/int.hh>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    namespace {
+        /**
+         * Propagator connecting a board to the placement boards of all parts on the same level.
+         *
+         * The propagator is domain consistent for each pair of board square and placement square. Advisors record
+         * the squares where some view changed, and only those squares are revisited.
+         */
+        class PlacementChannel : public Propagator {
+        protected:
+            /// Advisor for one view, knows the square of the view
+            class SquareAdvisor : public ViewAdvisor<Int::IntView> {
+            public:
+                /// The square of the view
+                const int square;
+
+                SquareAdvisor(Space& home, Propagator& p, Council<SquareAdvisor>& c, Int::IntView x, int s)
+                        : ViewAdvisor<Int::IntView>(home, p, c, x), square(s) {}
+
+                SquareAdvisor(Space& home, SquareAdvisor& a)
+                        : ViewAdvisor<Int::IntView>(home, a), square(a.square) {}
+            };
+
+            /// The squares of the level
+            ViewArray<Int::IntView> board_;
+            /// The placement boards of the parts, part p uses the squares p*board_.size() to (p+1)*board_.size()-1
+            ViewArray<Int::IntView> placements_;
+            /// The advisors for the views that are not assigned
+            Council<SquareAdvisor> council_;
+            /// The squares to revisit, the first ndirty_ entries are used
+            int* dirty_;
+            /// The number of squares to revisit
+            int ndirty_;
+            /// Whether each square is in dirty_
+            bool* marked_;
+
+            /// Add square \a s to the squares to revisit
+            void mark(int s) {
+                if (!marked_[s]) {
+                    marked_[s] = true;
+                    dirty_[ndirty_++] = s;
+                }
+            }
+
+            /// Constructor for posting
+            PlacementChannel(Home home, ViewArray<Int::IntView>& board, ViewArray<Int::IntView>& placements)
+                    : Propagator(home), board_(board), placements_(placements), council_(home),
+                      dirty_(home.alloc<int>(board.size())), ndirty_(0),
+                      marked_(home.alloc<bool>(board.size())) {
+                const int nsquares = board_.size();
+                for (int s = 0; s < nsquares; ++s) {
+                    marked_[s] = false;
+                    mark(s);
+                    if (!board_[s].assigned()) {
+                        (void) new (home) SquareAdvisor(home, *this, council_, board_[s], s);
+                    }
+                }
+                for (int i = 0; i < placements_.size(); ++i) {
+                    if (!placements_[i].assigned()) {
+                        (void) new (home) SquareAdvisor(home, *this, council_, placements_[i], i % nsquares);
+                    }
+                }
+                // All squares are dirty, propagate them once
+                Int::IntView::schedule(home, *this, Int::ME_INT_DOM);
+            }
+
+            /// Constructor for cloning \a p
+            PlacementChannel(Space& home, PlacementChannel& p)
+                    : Propagator(home, p), ndirty_(p.ndirty_) {
+                board_.update(home, p.board_);
+                placements_.update(home, p.placements_);
+                council_.update(home, p.council_);
+                const int nsquares = board_.size();
+                dirty_ = home.alloc<int>(nsquares);
+                marked_ = home.alloc<bool>(nsquares);
+                for (int s = 0; s < nsquares; ++s) {
+                    dirty_[s] = p.dirty_[s];
+                    marked_[s] = p.marked_[s];
+                }
+            }
+
+            /// Make square \a s domain consistent for all parts
+            ExecStatus propagate_square(Space& home, int s) {
+                const int nsquares = board_.size();
+                const int nparts = placements_.size() / nsquares;
+                Int::IntView square = board_[s];
+                for (int p = 0; p < nparts; ++p) {
+                    Int::IntView placement = placements_[p * nsquares + s];
+                    if (!placement.in(1)) {
+                        GECODE_ME_CHECK(square.nq(home, p + 1));
+                    } else if (placement.assigned()) {
+                        GECODE_ME_CHECK(square.eq(home, p + 1));
+                    }
+                    if (!square.in(p + 1)) {
+                        GECODE_ME_CHECK(placement.nq(home, 1));
+                    } else if (square.assigned()) {
+                        GECODE_ME_CHECK(placement.eq(home, 1));
+                    }
+                }
+                return ES_OK;
+            }
+
+        public:
+            /// Post the propagator
+            static ExecStatus post(Home home, ViewArray<Int::IntView>& board, ViewArray<Int::IntView>& placements) {
+                (void) new (home) PlacementChannel(home, board, placements);
+                return ES_OK;
+            }
+
+            Propagator* copy(Space& home) override {
+                return new (home) PlacementChannel(home, *this);
+            }
+
+            PropCost cost(const Space&, const ModEventDelta&) const override {
+                // Each square to revisit is checked against all the parts
+                return PropCost::linear(PropCost::LO, std::max(1, ndirty_) * (placements_.size() / board_.size()));
+            }
+
+            void reschedule(Space& home) override {
+                if (ndirty_ > 0) {
+                    Int::IntView::schedule(home, *this, Int::ME_INT_DOM);
+                }
+            }
+
+            size_t dispose(Space& home) override {
+                council_.dispose(home);
+                (void) Propagator::dispose(home);
+                return sizeof(*this);
+            }
+
+            ExecStatus advise(Space& home, Advisor& a, const Delta&) override {
+                auto& advisor = static_cast<SquareAdvisor&>(a);
+                mark(advisor.square);
+                if (advisor.view().assigned()) {
+                    return home.ES_NOFIX_DISPOSE(council_, advisor);
+                }
+                return ES_NOFIX;
+            }
+
+            ExecStatus propagate(Space& home, const ModEventDelta&) override {
+                // Changes made here mark squares again through the advisors, so continue until no square is left
+                while (ndirty_ > 0) {
+                    const int s = dirty_[--ndirty_];
+                    marked_[s] = false;
+                    GECODE_ES_CHECK(propagate_square(home, s));
+                }
+
+                if (council_.empty()) {
+                    return home.ES_SUBSUMED(*this);
+                }
+                return ES_FIX;
+            }
+        };
+    }
+
+    void placement_channel(Home home, const IntVarArgs& board, const IntVarArgs& placements) {
+        assert(board.size() > 0 && placements.size() % board.size() == 0);
+        GECODE_POST;
+
+        ViewArray<Int::IntView> board_views(home, board);
+        ViewArray<Int::IntView> placement_views(home, placements);
+        GECODE_ES_FAIL(PlacementChannel::post(home, board_views, placement_views));
+    }
+}
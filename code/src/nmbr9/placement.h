@@ -0,0 +1,27 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_PLACEMENT_H
+#define NMBR9_PLACEMENT_H
+
+#include <gecode/int.hh>
+
+namespace nmbr9 {
+
+    /**
+     * Post the connection (8) between the placement boards of all parts on a level and the board of the level.
+     *
+     * A square of the placement board of part p has value 1 if and only if the square of the board has value p+1.
+     * This replaces the Boolean part boards and their channeling in the compact placement encoding.
+     *
+     * @param home The space to post the constraint in
+     * @param board The squares of the level, value p+1 when occupied by part p and 0 when empty
+     * @param placements The placement boards of the level for all the parts, concatenated in part order
+     */
+    void placement_channel(Gecode::Home home,
+                           const Gecode::IntVarArgs& board,
+                           const Gecode::IntVarArgs& placements);
+}
+
+#endif //NMBR9_PLACEMENT_H
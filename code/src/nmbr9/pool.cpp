@@ -0,0 +1,103 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nmbr9 {
+
+    int worker_count(const double threads) {
+        const int hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        int workers;
+        if (threads >= 1.0) {
+            workers = static_cast<int>(threads);
+        } else if (threads > 0.0) {
+            workers = static_cast<int>(std::round(threads * hardware));
+        } else {
+            workers = hardware + static_cast<int>(threads);
+        }
+        return std::max(1, workers);
+    }
+
+    namespace {
+        /// Start the helper threads for workers 1..threads-1, run worker 0 on this thread, and wait for all
+        template <class Work>
+        void run_workers(const int threads, const Work& work) {
+            std::vector<std::thread> helpers;
+            helpers.reserve(threads - 1);
+            for (int worker = 1; worker < threads; ++worker) {
+                helpers.emplace_back(work, worker);
+            }
+            work(0);
+            for (auto& helper : helpers) {
+                helper.join();
+            }
+        }
+
+        /// The indices left for one worker, stolen from the back by other workers
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<int> indices;
+        };
+    }
+
+    void parallel_for(const int n, const int workers, const std::function<void(int worker, int i)>& body) {
+        std::atomic<int> next(0);
+        const auto work = [&](const int worker) {
+            for (int i = next++; i < n; i = next++) {
+                body(worker, i);
+            }
+        };
+
+        run_workers(std::max(1, std::min(workers, n)), work);
+    }
+
+    void work_stealing_for(const int n, const int workers, const std::function<void(int worker, int i)>& body) {
+        const int threads = std::max(1, std::min(workers, n));
+        std::vector<WorkQueue> queues(threads);
+        for (int worker = 0; worker < threads; ++worker) {
+            const int begin = static_cast<int>(static_cast<long>(n) * worker / threads);
+            const int end = static_cast<int>(static_cast<long>(n) * (worker + 1) / threads);
+            for (int i = begin; i < end; ++i) {
+                queues[worker].indices.push_back(i);
+            }
+        }
+
+        // No indices are added while running, so a worker is done when all the queues are empty
+        const auto take = [&](const int worker, int& i) {
+            for (int k = 0; k < threads; ++k) {
+                const int victim = (worker + k) % threads;
+                std::lock_guard<std::mutex> lock(queues[victim].mutex);
+                std::deque<int>& indices = queues[victim].indices;
+                if (indices.empty()) {
+                    continue;
+                }
+                if (victim == worker) {
+                    i = indices.front();
+                    indices.pop_front();
+                } else {
+                    i = indices.back();
+                    indices.pop_back();
+                }
+                return true;
+            }
+            return false;
+        };
+        const auto work = [&](const int worker) {
+            int i;
+            while (take(worker, i)) {
+                body(worker, i);
+            }
+        };
+
+        run_workers(threads, work);
+    }
+}
@@ -0,0 +1,51 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_POOL_H
+#define NMBR9_POOL_H
+
+#include <functional>
+
+namespace nmbr9 {
+
+    /**
+     * The number of workers to use for a thread count given as for Gecode search.
+     *
+     * A count of at least 1 is the number of workers, 0 means one worker per hardware thread, a count between 0
+     * and 1 is a fraction of the hardware threads, and a negative count is the number of hardware threads to leave
+     * unused.
+     *
+     * @return The number of workers, at least 1
+     */
+    int worker_count(double threads);
+
+    /**
+     * Run \a body for all indices 0..n-1 on \a workers threads, and wait for all of them to finish.
+     *
+     * The indices are handed out one at a time, so that workers that finish early take more of the indices. The
+     * body is called with the worker and the index, and each worker calls the body from a single thread, so
+     * state indexed by the worker needs no synchronization.
+     *
+     * @param n The number of indices
+     * @param workers The number of threads to use
+     * @param body The body to run for each index
+     */
+    void parallel_for(int n, int workers, const std::function<void(int worker, int i)>& body);
+
+    /**
+     * Run \a body for all indices 0..n-1 on \a workers threads with work stealing, and wait for all of them to
+     * finish.
+     *
+     * Each worker starts with its own contiguous block of the indices, and runs them in order. A worker that runs
+     * out of indices steals from the end of the block of another worker. This keeps neighbouring indices on the
+     * same worker, which pays off when neighbouring indices share state.
+     *
+     * @param n The number of indices
+     * @param workers The number of threads to use
+     * @param body The body to run for each index, called with the worker and the index
+     */
+    void work_stealing_for(int n, int workers, const std::function<void(int worker, int i)>& body);
+}
+
+#endif //NMBR9_POOL_H
@@ -0,0 +1,428 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "stacking.h"
+
+#include <gecode/int.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    namespace {
+        /**
+         * Propagator for the on-top requirements (10) and (11) on one pair of adjacent levels.
+         *
+         * Support for a part on a square of the upper level is a part on the same square of the lower level that
+         * may be before it in the order. A part on the upper level needs at least two different supporting parts.
+         *
+         * Advisors record the squares where the upper or lower level changed, and the parts whose order bounds
+         * changed, and only those squares are revisited. For (11), the propagator keeps the number of squares
+         * where each part may rest on each other part, from the domains seen at the last visit of each square,
+         * and only checks the parts whose counts dropped to zero or whose order changed.
+         */
+        class Stacking : public Propagator {
+        protected:
+            /// Bit set of parts, bit p for part p
+            typedef unsigned long long int Parts;
+
+            /// Advisor for one view, squares of the upper level use index s, of the lower level nsquares+s, and
+            /// the order of part p uses 2*nsquares+p
+            class IndexAdvisor : public ViewAdvisor<Int::IntView> {
+            public:
+                /// The index of the view
+                const int index;
+
+                IndexAdvisor(Space& home, Propagator& p, Council<IndexAdvisor>& c, Int::IntView x, int i)
+                        : ViewAdvisor<Int::IntView>(home, p, c, x), index(i) {}
+
+                IndexAdvisor(Space& home, IndexAdvisor& a)
+                        : ViewAdvisor<Int::IntView>(home, a), index(a.index) {}
+            };
+
+            /// The squares of the upper level
+            ViewArray<Int::IntView> upper_;
+            /// The squares of the lower level
+            ViewArray<Int::IntView> lower_;
+            /// The order of the parts in the deck
+            ViewArray<Int::IntView> order_;
+            /// Whether the parts are on the upper level, only read since a part is checked until it is off the level
+            ViewArray<Int::BoolView> on_level_;
+            /// The advisors for the views that are not assigned
+            Council<IndexAdvisor> council_;
+            /// The squares to revisit, the first ndirty_ entries are used
+            int* dirty_;
+            /// The number of squares to revisit
+            int ndirty_;
+            /// Whether each square is in dirty_
+            bool* marked_;
+            /// The parts that may be on each square of the upper level, as of the last visit of the square
+            Parts* above_;
+            /// The parts that may be on each square of the lower level, as of the last visit of the square
+            Parts* below_;
+            /// At index p*nparts+q, the number of squares where part p may rest on part q
+            int* rests_on_;
+            /// The parts whose order bounds changed since they were last handled
+            Parts moved_;
+            /// The parts to check for (11)
+            Parts check_;
+
+            /// Add square \a s to the squares to revisit
+            void mark(int s) {
+                if (!marked_[s]) {
+                    marked_[s] = true;
+                    dirty_[ndirty_++] = s;
+                }
+            }
+
+            /// The parts in the domain of \a x
+            static Parts parts(Int::IntView x) {
+                Parts result = 0;
+                for (Int::ViewValues<Int::IntView> v(x); v(); ++v) {
+                    if (v.val() > 0) {
+                        result |= Parts(1) << static_cast<unsigned int>(v.val() - 1);
+                    }
+                }
+                return result;
+            }
+
+            /// Whether part \a p is in \a set
+            static bool contains(Parts set, int p) {
+                return ((set >> static_cast<unsigned int>(p)) & 1u) != 0;
+            }
+
+            /// Constructor for posting
+            Stacking(Home home,
+                     ViewArray<Int::IntView>& upper, ViewArray<Int::IntView>& lower,
+                     ViewArray<Int::IntView>& order, ViewArray<Int::BoolView>& on_level)
+                    : Propagator(home), upper_(upper), lower_(lower), order_(order), on_level_(on_level),
+                      council_(home),
+                      dirty_(home.alloc<int>(upper.size())), ndirty_(0),
+                      marked_(home.alloc<bool>(upper.size())),
+                      above_(home.alloc<Parts>(upper.size())),
+                      below_(home.alloc<Parts>(upper.size())),
+                      rests_on_(home.alloc<int>(order.size() * order.size())),
+                      moved_(0), check_(0) {
+                const int nsquares = upper_.size();
+                const int nparts = order_.size();
+                for (int i = 0; i < nparts * nparts; ++i) {
+                    rests_on_[i] = 0;
+                }
+                for (int s = 0; s < nsquares; ++s) {
+                    above_[s] = parts(upper_[s]);
+                    below_[s] = parts(lower_[s]);
+                    for (int p = 0; p < nparts; ++p) {
+                        if (contains(above_[s], p)) {
+                            for (int q = 0; q < nparts; ++q) {
+                                if (contains(below_[s], q)) {
+                                    ++rests_on_[p * nparts + q];
+                                }
+                            }
+                        }
+                    }
+                    marked_[s] = false;
+                    mark(s);
+                    if (!upper_[s].assigned()) {
+                        (void) new (home) IndexAdvisor(home, *this, council_, upper_[s], s);
+                    }
+                    if (!lower_[s].assigned()) {
+                        (void) new (home) IndexAdvisor(home, *this, council_, lower_[s], nsquares + s);
+                    }
+                }
+                for (int p = 0; p < nparts; ++p) {
+                    check_ |= Parts(1) << static_cast<unsigned int>(p);
+                    if (!order_[p].assigned()) {
+                        (void) new (home) IndexAdvisor(home, *this, council_, order_[p], 2 * nsquares + p);
+                    }
+                }
+                // All squares and parts are dirty, propagate them once
+                Int::IntView::schedule(home, *this, Int::ME_INT_DOM);
+            }
+
+            /// Constructor for cloning \a p
+            Stacking(Space& home, Stacking& p)
+                    : Propagator(home, p), ndirty_(p.ndirty_), moved_(p.moved_), check_(p.check_) {
+                upper_.update(home, p.upper_);
+                lower_.update(home, p.lower_);
+                order_.update(home, p.order_);
+                on_level_.update(home, p.on_level_);
+                council_.update(home, p.council_);
+                const int nsquares = upper_.size();
+                const int nparts = order_.size();
+                dirty_ = home.alloc<int>(nsquares);
+                marked_ = home.alloc<bool>(nsquares);
+                above_ = home.alloc<Parts>(nsquares);
+                below_ = home.alloc<Parts>(nsquares);
+                for (int s = 0; s < nsquares; ++s) {
+                    dirty_[s] = p.dirty_[s];
+                    marked_[s] = p.marked_[s];
+                    above_[s] = p.above_[s];
+                    below_[s] = p.below_[s];
+                }
+                rests_on_ = home.alloc<int>(nparts * nparts);
+                for (int i = 0; i < nparts * nparts; ++i) {
+                    rests_on_[i] = p.rests_on_[i];
+                }
+            }
+
+            /// Part \a p no longer rests on part \a q on some square
+            void remove_pair(int p, int q) {
+                const int nparts = order_.size();
+                if (--rests_on_[p * nparts + q] == 0) {
+                    check_ |= Parts(1) << static_cast<unsigned int>(p);
+                }
+            }
+
+            /// Update the counts for (11) with the current domains of square \a s
+            void update_counts(int s) {
+                const int nparts = order_.size();
+                const Parts above = parts(upper_[s]);
+                const Parts below = parts(lower_[s]);
+                const Parts removed_above = above_[s] & ~above;
+                const Parts removed_below = below_[s] & ~below;
+                // The pairs lost are the removed parts above with the old parts below, and the remaining parts
+                // above with the removed parts below
+                if (removed_above != 0) {
+                    for (int p = 0; p < nparts; ++p) {
+                        if (contains(removed_above, p)) {
+                            for (int q = 0; q < nparts; ++q) {
+                                if (contains(below_[s], q)) {
+                                    remove_pair(p, q);
+                                }
+                            }
+                        }
+                    }
+                }
+                if (removed_below != 0) {
+                    for (int p = 0; p < nparts; ++p) {
+                        if (contains(above, p)) {
+                            for (int q = 0; q < nparts; ++q) {
+                                if (contains(removed_below, q)) {
+                                    remove_pair(p, q);
+                                }
+                            }
+                        }
+                    }
+                }
+                above_[s] = above;
+                below_[s] = below;
+            }
+
+            /// Revisit the squares where part \a p may be, and the parts that may rest on it
+            void order_moved(int p) {
+                const int nsquares = upper_.size();
+                const int nparts = order_.size();
+                for (int s = 0; s < nsquares; ++s) {
+                    if (contains(above_[s] | below_[s], p)) {
+                        mark(s);
+                    }
+                }
+                check_ |= Parts(1) << static_cast<unsigned int>(p);
+                for (int r = 0; r < nparts; ++r) {
+                    if (rests_on_[r * nparts + p] > 0) {
+                        check_ |= Parts(1) << static_cast<unsigned int>(r);
+                    }
+                }
+            }
+
+            /// Propagate requirement (11) for part \a p
+            ExecStatus check_part(Space& home, int p) {
+                if (on_level_[p].zero()) {
+                    return ES_OK;
+                }
+                const int nparts = order_.size();
+                int supporting_parts = 0;
+                for (int q = 0; q < nparts && supporting_parts < 2; ++q) {
+                    if (q != p && rests_on_[p * nparts + q] > 0 && order_[q].min() < order_[p].max()) {
+                        ++supporting_parts;
+                    }
+                }
+                if (supporting_parts < 2) {
+                    GECODE_ME_CHECK(on_level_[p].zero(home));
+                }
+                return ES_OK;
+            }
+
+            /**
+             * Propagate requirement (10) for one square.
+             *
+             * @return ES_FAILED if the square can not be supported
+             */
+            ExecStatus support_square(Space& home, int s) {
+                Int::IntView above = upper_[s];
+                Int::IntView below = lower_[s];
+
+                if (below.assigned() && below.val() == 0) {
+                    GECODE_ME_CHECK(above.eq(home, 0));
+                    return ES_OK;
+                }
+
+                if (above.assigned()) {
+                    if (above.val() == 0) {
+                        return ES_OK;
+                    }
+                    const int p = above.val() - 1;
+                    GECODE_ME_CHECK(below.nq(home, 0));
+                    GECODE_ME_CHECK(below.nq(home, p + 1));
+                    if (below.assigned()) {
+                        const int q = below.val() - 1;
+                        GECODE_ME_CHECK(order_[p].gq(home, order_[q].min() + 1));
+                        GECODE_ME_CHECK(order_[q].lq(home, order_[p].max() - 1));
+                    } else {
+                        Region r;
+                        int* unsupported = r.alloc<int>(below.size());
+                        int n = 0;
+                        for (Int::ViewValues<Int::IntView> v(below); v(); ++v) {
+                            const int q = v.val() - 1;
+                            if (q >= 0 && order_[q].min() >= order_[p].max()) {
+                                unsupported[n++] = v.val();
+                            }
+                        }
+                        for (int i = 0; i < n; ++i) {
+                            GECODE_ME_CHECK(below.nq(home, unsupported[i]));
+                        }
+                    }
+                    return ES_OK;
+                }
+
+                // The two earliest parts below, so that a part is never its own support
+                int first_part = -1, first_order = INT_MAX;
+                int second_order = INT_MAX;
+                for (Int::ViewValues<Int::IntView> v(below); v(); ++v) {
+                    const int q = v.val() - 1;
+                    if (q < 0) {
+                        continue;
+                    }
+                    if (order_[q].min() < first_order) {
+                        second_order = first_order;
+                        first_part = q;
+                        first_order = order_[q].min();
+                    } else if (order_[q].min() < second_order) {
+                        second_order = order_[q].min();
+                    }
+                }
+
+                Region r;
+                int* unsupported = r.alloc<int>(above.size());
+                int n = 0;
+                for (Int::ViewValues<Int::IntView> v(above); v(); ++v) {
+                    const int p = v.val() - 1;
+                    if (p < 0) {
+                        continue;
+                    }
+                    const int earliest = p != first_part ? first_order : second_order;
+                    if (earliest >= order_[p].max()) {
+                        unsupported[n++] = v.val();
+                    }
+                }
+                for (int i = 0; i < n; ++i) {
+                    GECODE_ME_CHECK(above.nq(home, unsupported[i]));
+                }
+                return ES_OK;
+            }
+
+        public:
+            /// Post the propagator
+            static ExecStatus post(Home home,
+                                   ViewArray<Int::IntView>& upper, ViewArray<Int::IntView>& lower,
+                                   ViewArray<Int::IntView>& order, ViewArray<Int::BoolView>& on_level) {
+                (void) new (home) Stacking(home, upper, lower, order, on_level);
+                return ES_OK;
+            }
+
+            Propagator* copy(Space& home) override {
+                return new (home) Stacking(home, *this);
+            }
+
+            PropCost cost(const Space&, const ModEventDelta&) const override {
+                // Each square to revisit is checked against the parts in its domains
+                return PropCost::linear(PropCost::LO, std::max(1, ndirty_) * order_.size());
+            }
+
+            void reschedule(Space& home) override {
+                if (ndirty_ > 0 || moved_ != 0 || check_ != 0) {
+                    Int::IntView::schedule(home, *this, Int::ME_INT_DOM);
+                }
+            }
+
+            size_t dispose(Space& home) override {
+                council_.dispose(home);
+                (void) Propagator::dispose(home);
+                return sizeof(*this);
+            }
+
+            ExecStatus advise(Space& home, Advisor& a, const Delta& d) override {
+                auto& advisor = static_cast<IndexAdvisor&>(a);
+                const int nsquares = upper_.size();
+                if (advisor.index < 2 * nsquares) {
+                    mark(advisor.index % nsquares);
+                } else if (Int::IntView::modevent(d) != Int::ME_INT_DOM) {
+                    // Only the bounds of the order are used
+                    moved_ |= Parts(1) << static_cast<unsigned int>(advisor.index - 2 * nsquares);
+                }
+                if (advisor.view().assigned()) {
+                    return home.ES_NOFIX_DISPOSE(council_, advisor);
+                }
+                return ES_NOFIX;
+            }
+
+            ExecStatus propagate(Space& home, const ModEventDelta&) override {
+                const int nparts = order_.size();
+
+                // Changes made here mark squares and parts again through the advisors, so continue until none is left
+                while (moved_ != 0 || ndirty_ > 0) {
+                    for (int p = 0; p < nparts && moved_ != 0; ++p) {
+                        if (contains(moved_, p)) {
+                            moved_ &= ~(Parts(1) << static_cast<unsigned int>(p));
+                            order_moved(p);
+                        }
+                    }
+                    // (10) Every square of a part rests on an earlier part
+                    while (ndirty_ > 0) {
+                        const int s = dirty_[--ndirty_];
+                        marked_[s] = false;
+                        GECODE_ES_CHECK(support_square(home, s));
+                        update_counts(s);
+                    }
+                }
+
+                // (11) Every part rests on at least two different earlier parts, only changes the levels of parts
+                for (int p = 0; p < nparts && check_ != 0; ++p) {
+                    if (contains(check_, p)) {
+                        check_ &= ~(Parts(1) << static_cast<unsigned int>(p));
+                        GECODE_ES_CHECK(check_part(home, p));
+                    }
+                }
+
+                if (council_.empty()) {
+                    return home.ES_SUBSUMED(*this);
+                }
+                return ES_FIX;
+            }
+        };
+    }
+
+    void stacking(Home home,
+                  const IntVarArgs& upper,
+                  const IntVarArgs& lower,
+                  const IntVarArgs& order,
+                  const BoolVarArgs& on_level) {
+        assert(upper.size() == lower.size());
+        assert(on_level.size() == order.size());
+        if (order.size() > 64) {
+            throw Int::OutOfLimits("nmbr9::stacking");
+        }
+        GECODE_POST;
+
+        ViewArray<Int::IntView> upper_views(home, upper);
+        ViewArray<Int::IntView> lower_views(home, lower);
+        ViewArray<Int::IntView> order_views(home, order);
+        ViewArray<Int::BoolView> on_level_views(home, on_level);
+        GECODE_ES_FAIL(Stacking::post(home, upper_views, lower_views, order_views, on_level_views));
+    }
+}
@@ -0,0 +1,33 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_STACKING_H
+#define NMBR9_STACKING_H
+
+#include <gecode/int.hh>
+
+namespace nmbr9 {
+
+    /**
+     * Post the on-top requirements (10) and (11) for one pair of adjacent levels.
+     *
+     * Every square occupied by a part on the upper level must be occupied by a part placed before it on the
+     * lower level, and a part on the upper level must rest on at least two different parts. The propagator works
+     * directly on the two boards, so no auxiliary variables are created per pair of parts. Only the squares and
+     * parts that changed since the last propagation are revisited. At most 64 parts are supported.
+     *
+     * @param home The space to post the constraint in
+     * @param upper The squares of the upper level, value p+1 when occupied by part p and 0 when empty
+     * @param lower The squares of the level directly below \a upper
+     * @param order The order of the parts in the deck
+     * @param on_level The parts that are on the upper level
+     */
+    void stacking(Gecode::Home home,
+                  const Gecode::IntVarArgs& upper,
+                  const Gecode::IntVarArgs& lower,
+                  const Gecode::IntVarArgs& order,
+                  const Gecode::BoolVarArgs& on_level);
+}
+
+#endif //NMBR9_STACKING_H
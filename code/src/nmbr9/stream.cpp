@@ -0,0 +1,202 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "stream.h"
+#include "pool.h"
+#include "tiles.h"
+
+#include <gecode/search.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+
+using namespace Gecode;
+
+namespace nmbr9 {
+
+    StreamingPlayer::StreamingPlayer(const Nmbr9Options& opt, const unsigned int card_time, const double threads)
+            : instance_(opt.instance()),
+              ncards_(opt.deck_size()),
+              card_time_(card_time),
+              threads_(threads),
+              root_(new Nmbr9Board(opt, Layout(), true, false)),
+              game_(),
+              layout_(),
+              used_(opt.number_of_parts(), false),
+              score_(0)
+    {
+        // Propagate once, so that each game starts from the same stable space
+        root_->status();
+        reset();
+    }
+
+    void StreamingPlayer::reset() {
+        game_.reset(static_cast<Nmbr9Board*>(root_->clone()));
+        layout_.clear();
+        used_.assign(used_.size(), false);
+        score_ = 0;
+    }
+
+    bool StreamingPlayer::play(const int value) {
+        if (done()) {
+            return false;
+        }
+        int part = -1;
+        for (int p = 0; p < static_cast<int>(used_.size()); ++p) {
+            if (!used_[p] && tile_value(instance_, p + 1) == value) {
+                part = p;
+                break;
+            }
+        }
+        if (part < 0) {
+            return false;
+        }
+
+        // Search a clone, so that the game is unchanged if the card can not be placed
+        std::unique_ptr<Nmbr9Board> game(static_cast<Nmbr9Board*>(game_->clone()));
+        const int card = cards();
+        game->reveal(card, part);
+        if (game->status() == SS_FAILED) {
+            return false;
+        }
+
+        Search::Options so;
+        so.threads = threads_;
+        std::unique_ptr<Search::Stop> stop;
+        if (card_time_ > 0) {
+            stop = std::make_unique<Search::TimeStop>(card_time_);
+            so.stop = stop.get();
+        }
+        std::unique_ptr<Nmbr9Board> best;
+        {
+            BAB<Nmbr9Board> engine(game.get(), so);
+            while (Nmbr9Board* solution = engine.next()) {
+                best.reset(solution);
+            }
+        }
+        if (!best && card_time_ > 0) {
+            // Out of time without any layout, settle for the first layout found within another budget
+            stop = std::make_unique<Search::TimeStop>(card_time_);
+            so.stop = stop.get();
+            DFS<Nmbr9Board> engine(game.get(), so);
+            best.reset(engine.next());
+        }
+        if (!best) {
+            return false;
+        }
+
+        game->keep_part(*best, part);
+        game_ = std::move(game);
+        const Placement placement = best->layout()[card];
+        layout_.emplace_back(placement);
+        used_[part] = true;
+        score_ += tile_value(instance_, part + 1) * placement.level;
+        return true;
+    }
+
+    int run_stream(const Nmbr9Options& opt) {
+        StreamingPlayer player(opt, opt.card_time(), opt.threads());
+        std::cout << "Ready for " << opt.deck_size() << " cards" << std::endl;
+
+        int value;
+        while (!player.done() && std::cin >> value) {
+            const auto start = std::chrono::steady_clock::now();
+            const bool placed = player.play(value);
+            const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+            if (!placed) {
+                std::cout << "Card " << player.cards() << ": value " << value << " can not be placed" << std::endl;
+                return -1;
+            }
+            const Placement& placement = player.layout().back();
+            std::cout << "Card " << player.cards() - 1 << ": value " << value
+                      << " placed as " << placement
+                      << " in " << duration.count() << " ms" << std::endl;
+        }
+
+        std::cout << "Score : " << player.score() << std::endl;
+        std::cout << "Layout : " << player.layout() << std::endl;
+        return player.score();
+    }
+
+    namespace {
+        /// The score of a game where some card could not be placed
+        constexpr int failed_game_score = 0;
+    }
+
+    int run_evaluate(const Nmbr9Options& opt) {
+        const auto start = std::chrono::steady_clock::now();
+        const int samples = static_cast<int>(opt.samples());
+        const int workers = std::min(worker_count(opt.threads()), std::max(1, samples));
+        const int nparts = opt.number_of_parts();
+        const int ncards = opt.deck_size();
+        const Instance instance = opt.instance();
+
+        // Each worker builds its own model once, and plays all its samples from clones of it
+        std::vector<std::unique_ptr<StreamingPlayer>> players(workers);
+        std::vector<int> scores(samples, -1);
+        parallel_for(samples, workers, [&](const int worker, const int sample) {
+            if (!players[worker]) {
+                players[worker] = std::make_unique<StreamingPlayer>(opt, opt.card_time(), 1);
+            }
+            StreamingPlayer& player = *players[worker];
+
+            std::vector<int> parts(nparts);
+            std::iota(parts.begin(), parts.end(), 0);
+            std::seed_seq seed{opt.seed(), static_cast<unsigned int>(sample)};
+            std::mt19937 rnd(seed);
+            std::shuffle(parts.begin(), parts.end(), rnd);
+
+            player.reset();
+            for (int c = 0; c < ncards; ++c) {
+                if (!player.play(tile_value(instance, parts[c] + 1))) {
+                    return;
+                }
+            }
+            scores[sample] = player.score();
+        });
+
+        // A failed game scores nothing, leaving it out would bias the estimate towards the easy decks
+        int failures = 0;
+        double sum = 0, completed_sum = 0;
+        int min_score = std::numeric_limits<int>::max(), max_score = 0;
+        for (int& score : scores) {
+            if (score < 0) {
+                ++failures;
+                score = failed_game_score;
+            } else {
+                completed_sum += score;
+            }
+            sum += score;
+            min_score = std::min(min_score, score);
+            max_score = std::max(max_score, score);
+        }
+        const double mean = samples > 0 ? sum / samples : 0.0;
+        double squares = 0;
+        for (int score : scores) {
+            squares += (score - mean) * (score - mean);
+        }
+        const double variance = samples > 1 ? squares / (samples - 1) : 0.0;
+        const double half_width = samples > 0 ? 1.96 * std::sqrt(variance / samples) : 0.0;
+        const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+
+        std::cout << "Samples : " << samples << " on " << workers << " threads in " << duration.count() << " ms"
+                  << std::endl;
+        std::cout << "Failed : " << failures << ", counted with score " << failed_game_score << std::endl;
+        if (samples > 0) {
+            std::cout << "Mean : " << mean << std::endl;
+            std::cout << "Variance : " << variance << std::endl;
+            std::cout << "95% CI : [" << mean - half_width << ", " << mean + half_width << "]" << std::endl;
+            std::cout << "Range : [" << min_score << ", " << max_score << "]" << std::endl;
+        }
+        if (failures > 0 && failures < samples) {
+            std::cout << "Mean of completed games : " << completed_sum / (samples - failures) << std::endl;
+        }
+        return failures;
+    }
+}
@@ -0,0 +1,115 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_STREAM_H
+#define NMBR9_STREAM_H
+
+#include "lib.h"
+#include "verify.h"
+
+#include <memory>
+#include <vector>
+
+namespace nmbr9 {
+
+    /**
+     * Plays a game where the cards are revealed one at a time, and each card must be placed before the next one
+     * is revealed.
+     *
+     * The model is built once. A game starts from a clone of the model, and each card is fixed in the deck of the
+     * game. The best layout that starts with the revealed cards is searched for within the time budget per card,
+     * and the placement of the new card in that layout is committed to the game. The cards that are not yet
+     * revealed are decided as for the play type of the options, so a free play type plays optimistically.
+     *
+     * The symmetries of the layout are not broken in the model. A committed placement need not be the
+     * representative of its symmetry class, and breaking the symmetries would then remove legal placements for
+     * the later cards.
+     */
+    class StreamingPlayer {
+        /// The instance played
+        const Instance instance_;
+        /// The number of cards in a game
+        const int ncards_;
+        /// The search time per card in milliseconds, 0 for no limit
+        const unsigned int card_time_;
+        /// The number of threads to search with
+        const double threads_;
+        /// The model, after the initial propagation
+        std::unique_ptr<Nmbr9Board> root_;
+        /// The model with the revealed cards and the committed placements of the current game
+        std::unique_ptr<Nmbr9Board> game_;
+        /// The placements committed so far, in deck order
+        Layout layout_;
+        /// The parts used so far
+        std::vector<bool> used_;
+        /// The score of the committed placements
+        int score_;
+    public:
+        /**
+         * @param opt The options for the model
+         * @param card_time The search time per card in milliseconds, 0 for no limit
+         * @param threads The number of threads to search with, as for Gecode search
+         */
+        StreamingPlayer(const Nmbr9Options& opt, unsigned int card_time, double threads);
+
+        /// Start a new game, from a clone of the model
+        void reset();
+
+        /**
+         * Reveal the next card and commit a placement for it.
+         *
+         * The card is the first unused part with the value. If no layout is found within the time per card, the
+         * first layout found within the same time again is used, so a card takes at most twice the time per card.
+         * If no part with the value is left, or if no layout with the revealed cards is found, then nothing is
+         * committed.
+         *
+         * @param value The value of the card
+         * @return True if the card was placed
+         */
+        bool play(int value);
+
+        /// The number of cards placed in the current game
+        int cards() const {
+            return static_cast<int>(layout_.size());
+        }
+
+        /// True when all the cards of the game are placed
+        bool done() const {
+            return cards() == ncards_;
+        }
+
+        /// The score of the placements in the current game
+        int score() const {
+            return score_;
+        }
+
+        /// The placements in the current game, in deck order
+        const Layout& layout() const {
+            return layout_;
+        }
+    };
+
+    /**
+     * Play the cards on standard input as they are read, with the search time per card in the options, and
+     * print each placement as it is decided.
+     *
+     * @return The score of the game, or -1 if some card could not be placed
+     */
+    int run_stream(const Nmbr9Options& opt);
+
+    /**
+     * Estimate the expected score of streaming play over random decks.
+     *
+     * Each sample shuffles all the parts with its own seed, derived from the seed in the options, and plays the
+     * first cards as a streaming game. The samples are spread over the threads in the options, and each thread
+     * plays with its own StreamingPlayer, which searches single-threaded. Reports the mean, the variance, and a 95%
+     * confidence interval of the scores over all the games, where a game in which some card could not be placed
+     * scores 0. The mean of the games where all cards were placed is also reported.
+     *
+     * @return The number of games where some card could not be placed
+     */
+    int run_evaluate(const Nmbr9Options& opt);
+}
+
+#endif //NMBR9_STREAM_H
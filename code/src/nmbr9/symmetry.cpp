@@ -4,8 +4,12 @@
 
 #include "symmetry.h"
 
+#include <gecode/minimodel.hh>
+
 #include <cassert>
 
+using namespace Gecode;
+
 namespace nmbr9::symmetry {
     int pos(int h, int w, int h1, int w1) {
         assert(0 <= h && h < h1);
@@ -13,4 +17,35 @@ namespace nmbr9::symmetry {
 
         return h * w1 + w;
     }
+
+    void centered(Home home, const IntVarArgs& board, const int wh) {
+        BoolVarArgs occupied;
+        for (int s = 0; s < board.size(); ++s) {
+            occupied << expr(home, board[s] != 0);
+        }
+        Matrix<BoolVarArgs> m(occupied, wh, wh);
+
+        BoolVarArgs row_used, column_used;
+        for (int i = 0; i < wh; ++i) {
+            BoolVar row(home, 0, 1);
+            rel(home, BOT_OR, m.row(i), row);
+            row_used << row;
+            BoolVar column(home, 0, 1);
+            rel(home, BOT_OR, m.col(i), column);
+            column_used << column;
+        }
+
+        // The number of unused rows or columns before the first used one, and after the last used one
+        const auto balance = [&](const BoolVarArgs& used) {
+            BoolVarArgs seen_from_start(wh), seen_from_end(wh);
+            for (int i = 0; i < wh; ++i) {
+                seen_from_start[i] = i == 0 ? used[0] : expr(home, seen_from_start[i-1] || used[i]);
+                const int j = wh - 1 - i;
+                seen_from_end[j] = i == 0 ? used[j] : expr(home, seen_from_end[j+1] || used[j]);
+            }
+            rel(home, abs(sum(seen_from_start) - sum(seen_from_end)) <= 1);
+        };
+        balance(row_used);
+        balance(column_used);
+    }
 }
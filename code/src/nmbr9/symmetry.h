@@ -5,6 +5,8 @@
 #ifndef NMBR9_SYMMETRY_H
 #define NMBR9_SYMMETRY_H
 
+#include <gecode/int.hh>
+
 #include <vector>
 
 namespace nmbr9::symmetry {
@@ -63,6 +65,18 @@ namespace nmbr9::symmetry {
                     t2[pos(h2 - w - 1, h, h2, w2)] = t1[pos(h, w, h1, w1)];
         }
 
+        /**
+         * Break the translation symmetry of a layout by centering the occupied squares of a board.
+         *
+         * The number of empty rows above and below the occupied squares differ by at most one, and the same for
+         * the empty columns to the left and to the right. This is compatible with breaking the rotational
+         * symmetries, since a rotation of a centered board is also centered.
+         *
+         * @param home The space to post the constraint in
+         * @param board The squares of the bottom level in row-major order, 0 when empty
+         * @param wh The width and height of the board
+         */
+        void centered(Gecode::Home home, const Gecode::IntVarArgs& board, int wh);
 }
 
 #endif //NMBR9_SYMMETRY_H
@@ -6,7 +6,10 @@
 #pragma ide diagnostic ignored "OCUnusedGlobalDeclarationInspection"
 #pragma ide diagnostic ignored "misc-static-assert"
 
-#include <map>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <iostream>
 #include <gecode/minimodel.hh>
 #include <gecode/int.hh>
@@ -17,10 +20,11 @@
 #include "tiles.h"
 #include "symmetry.h"
 #include "base.h"
+#include "footprints.h"
 
 namespace nmbr9 {
-    Tile::Tile(int width, int height, std::vector<int> marks) : width(width), height(height), marks(std::move(marks)) {
-        assert(this->marks.size() == width * height);
+    Tile::Tile(int width, int height, std::vector<int> marks) : width_(width), height_(height), marks_(std::move(marks)) {
+        assert(marks_.size() == width * height);
     }
 
     const Gecode::REG Tile::make_placement_expression(Instance instance) const {
@@ -30,14 +34,14 @@ namespace nmbr9 {
         REG empty(0);
 
         // The fixed separation between rows
-        const auto fixed_separation_length = instance.wh() - width;
+        const auto fixed_separation_length = instance.wh() - width_;
         const REG fixed_separation = empty(fixed_separation_length, fixed_separation_length);
 
         // Start anywhere (that is, with arbitrary number of empty squares)
         REG result = *empty;
 
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
+        for (int y = 0; y < height_; ++y) {
+            for (int x = 0; x < width_; ++x) {
                 switch (at(x, y)) {
                     case 0:
                         result += empty;
@@ -52,7 +56,7 @@ namespace nmbr9 {
                         GECODE_NEVER
                 }
             }
-            if (y < height - 1) {
+            if (y < height_ - 1) {
                 // Between rows, add the fixed separation
                 result += fixed_separation;
             }
@@ -72,7 +76,8 @@ namespace nmbr9 {
               value_(value),
               area_(count_area(width, height, tile_pattern)),
               alternatives_(make_unique_tiles(width, height, tile_pattern)),
-              placement_expression_(make_placement_expression(instance, alternatives_))
+              placement_expression_(make_placement_expression(instance, alternatives_)),
+              placement_automaton_(make_placement_automaton(instance, placement_expression_))
               {}
 
     std::vector<Tile> TileSource::make_unique_tiles(const int width, const int height, const char *tile_pattern) {
@@ -154,11 +159,30 @@ namespace nmbr9 {
         return result;
     }
 
+    const Gecode::DFA TileSource::make_placement_automaton(Instance instance, const Gecode::REG& placement_expression) {
+        using Gecode::REG;
+
+        const int nsquares = instance.wh() * instance.wh();
+        REG reified_placement =
+                (REG(1) + // Placement for control variable
+                 placement_expression // Placement on board
+                ) |
+                (REG(0) + // No placement for control variable
+                 REG(0)(nsquares, nsquares) // No placement on board
+                );
+
+        return Gecode::DFA(reified_placement);
+    }
+
     
     const Gecode::REG TileSource::as_placement_expression() const {
         return placement_expression_;
     }
 
+    const Gecode::DFA& TileSource::placement_automaton() const {
+        return placement_automaton_;
+    }
+
     const int TileSource::id() const {
         return id_;
     }
@@ -171,6 +195,10 @@ namespace nmbr9 {
         return area_;
     }
 
+    const std::vector<Tile>& TileSource::alternatives() const {
+        return alternatives_;
+    }
+
 
     const std::vector<AbstractTileSource> base_tiles = { // NOLINT(cert-err58-cpp)
             {0,
@@ -266,10 +294,93 @@ namespace nmbr9 {
 
     };
 
+    /**
+     * The tiles of one instance. There is one tile source per tile id, the copies of a tile all refer to the same
+     * source. Values and areas are also stored in flat tables indexed by source.
+     *
+     * The tiles only depend on the values, the copies, and the grid size, so instances that only differ in the
+     * play type or the deck size share the same entry.
+     */
+    class InstanceTiles
+    {
+    private:
+        const Instance instance_;
+        const int copies_;
+        std::vector<TileSource> sources_;
+        std::array<int8_t, base_tile_count> values_;
+        std::array<int8_t, base_tile_count> areas_;
+        std::vector<FootprintTable> footprints_;
+        /// The next entry in the registry, only written before the entry is published
+        const InstanceTiles *next_;
+        friend class TileSources;
+    public:
+        explicit InstanceTiles(Instance instance) :
+                instance_(instance),
+                copies_(instance.copies()),
+                sources_(),
+                values_(),
+                areas_(),
+                footprints_(),
+                next_(nullptr)
+        {
+            assert(base_tiles.size() == base_tile_count);
+            sources_.reserve(base_tile_count);
+            footprints_.reserve(base_tile_count);
+            for (const auto &abstract_tile : base_tiles) {
+                if (abstract_tile.value() <= instance.max_value()) {
+                    sources_.emplace_back(abstract_tile.as_tile_source(instance));
+                    const TileSource &source = sources_.back();
+                    values_[sources_.size() - 1] = static_cast<int8_t>(source.value());
+                    areas_[sources_.size() - 1] = static_cast<int8_t>(source.area());
+                    footprints_.emplace_back(source, instance.wh());
+                }
+            }
+            assert(instance.number_of_parts() == sources_.size() * copies_);
+        }
+
+        [[nodiscard]] const Instance &instance() const {
+            return instance_;
+        }
+
+        /// The index of the tile source for \a tile, the copies of a tile are consecutive
+        [[nodiscard]] int source_index(int tile) const {
+            assert(0 < tile && tile <= instance_.number_of_parts());
+            return (tile - 1) / copies_;
+        }
+
+        [[nodiscard]] const TileSource &source(int tile) const {
+            return sources_[source_index(tile)];
+        }
+
+        [[nodiscard]] int value(int tile) const {
+            return values_[source_index(tile)];
+        }
+
+        [[nodiscard]] int area(int tile) const {
+            return areas_[source_index(tile)];
+        }
+
+        [[nodiscard]] const FootprintTable &footprints(int tile) const {
+            return footprints_[source_index(tile)];
+        }
+
+        InstanceTiles(InstanceTiles const&) = delete;
+        void operator=(InstanceTiles const&)  = delete;
+    };
+
+    /**
+     * Registry of the tiles for all instances used.
+     *
+     * The registry is a list of immutable entries. Lookups only follow the list from an atomically loaded head,
+     * and new entries are built without any lock and published with a compare-and-swap. If two threads build the
+     * same instance at the same time, one of the entries is discarded. This makes it safe to use the tiles from
+     * parallel search and from several models built at the same time, without serializing on a mutex.
+     */
     class TileSources
     {
     private:
-        std::map<Instance, const std::vector<TileSource>> sources_;
+        /// The most recently published entry
+        std::atomic<const InstanceTiles*> head_;
     public:
         static TileSources& instance()
         {
@@ -278,41 +389,78 @@ namespace nmbr9 {
             return instance;
         }
     private:
-        static const std::vector<TileSource> collect_sources(Instance instance) noexcept {
-            std::vector<TileSource> result;
-            for (const auto &abstract_tile : base_tiles) {
-                if (abstract_tile.value() <= instance.max_value()) {
-                    TileSource tile = abstract_tile.as_tile_source(instance);
-                    for (int i = 0; i < instance.copies(); ++i) {
-                        result.emplace_back(tile);
-                    }
+        /// Find the tiles of \a instance in the entries from \a first up to but not including \a last
+        static const InstanceTiles *find(const InstanceTiles *first, const InstanceTiles *last,
+                                         const Instance &instance) {
+            for (const InstanceTiles *entry = first; entry != last; entry = entry->next_) {
+                if (entry->instance().same_tiles(instance)) {
+                    return entry;
                 }
             }
-            assert(instance.number_of_parts() == result.size());
-            return result;
+            return nullptr;
         }
 
-        void ensure_exists(const Instance &instance) {
-            if (sources_.count(instance) == 0) {
-                sources_.insert(std::make_pair(instance, collect_sources(instance)));
+        const InstanceTiles &ensure_exists(const Instance &instance) {
+            const InstanceTiles *head = head_.load(std::memory_order_acquire);
+            if (const InstanceTiles *found = find(head, nullptr, instance)) {
+                return *found;
+            }
+
+            auto fresh = std::make_unique<InstanceTiles>(instance);
+            // The entries from checked and onwards are known not to contain the instance
+            const InstanceTiles *checked = head;
+            while (true) {
+                fresh->next_ = head;
+                if (head_.compare_exchange_weak(head, fresh.get(),
+                                                std::memory_order_release,
+                                                std::memory_order_acquire)) {
+                    return *fresh.release();
+                }
+                // Someone else published entries in between, check that they did not add the same instance
+                if (const InstanceTiles *found = find(head, checked, instance)) {
+                    return *found;
+                }
+                checked = head;
             }
         }
 
 
         TileSources() :
-                sources_()
+                head_(nullptr)
         {
         }
-        friend TileSource tile(Instance instance, int tile);
+
+        ~TileSources() {
+            const InstanceTiles *entry = head_.load(std::memory_order_acquire);
+            while (entry != nullptr) {
+                const InstanceTiles *next = entry->next_;
+                delete entry;
+                entry = next;
+            }
+        }
+        friend const TileSource& tile(Instance instance, int tile);
+        friend int tile_value(Instance instance, int tile);
+        friend int tile_area(Instance instance, int tile);
+        friend const FootprintTable& footprints(Instance instance, int tile);
     public:
         TileSources(TileSources const&) = delete;
         void operator=(TileSources const&)  = delete;
     };
 
-    TileSource tile(Instance instance, int tile) {
-        TileSources::instance().ensure_exists(instance);
-        assert(0 < tile && tile <= instance.number_of_parts());
-        return TileSources::instance().sources_[instance][tile-1];
+    const TileSource& tile(Instance instance, int tile) {
+        return TileSources::instance().ensure_exists(instance).source(tile);
+    }
+
+    int tile_value(Instance instance, int tile) {
+        return TileSources::instance().ensure_exists(instance).value(tile);
+    }
+
+    int tile_area(Instance instance, int tile) {
+        return TileSources::instance().ensure_exists(instance).area(tile);
+    }
+
+    const FootprintTable& footprints(Instance instance, int tile) {
+        return TileSources::instance().ensure_exists(instance).footprints(tile);
     }
 
 }
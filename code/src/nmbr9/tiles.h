@@ -10,6 +10,7 @@
 #include <vector>
 #include <gecode/minimodel.hh>
 #include "base.h"
+#include "footprints.h"
 
 namespace nmbr9 {
 
@@ -22,14 +23,24 @@ namespace nmbr9 {
      * \relates Nmbr9Model
      */
     class Tile {
-        const int width;  ///< Width of tile
-        const int height; ///< Height of tile
-        const std::vector<int> marks; ///< The row-major marks of the tile in a minimum bounding box
+        const int width_;  ///< Width of tile
+        const int height_; ///< Height of tile
+        const std::vector<int> marks_; ///< The row-major marks of the tile in a minimum bounding box
     public:
         Tile(int width, int height, std::vector<int> marks);
 
         const Gecode::REG make_placement_expression(Instance instance) const;
 
+        /// Width of the tile, including the squares around it
+        inline int width() const {
+            return width_;
+        }
+
+        /// Height of the tile, including the squares around it
+        inline int height() const {
+            return height_;
+        }
+
         inline int operator()(int x, int y) const {
             return at(x, y);
         }
@@ -41,17 +52,17 @@ namespace nmbr9 {
          * @return The value at (x, y)
          */
         inline int at(int x, int y) const {
-            assert(0 <= x && x < width);
-            assert(0 <= y && y < height);
-            return marks[y * width + x];
+            assert(0 <= x && x < width_);
+            assert(0 <= y && y < height_);
+            return marks_[y * width_ + x];
         }
 
         inline bool operator==(const Tile &rhs) const noexcept {
-            if (width != rhs.width || height != rhs.height) {
+            if (width_ != rhs.width_ || height_ != rhs.height_) {
                 return false;
             }
-            for (int i = 0; i < marks.size(); ++i) {
-                if (marks[i] != rhs.marks[i]) {
+            for (int i = 0; i < marks_.size(); ++i) {
+                if (marks_[i] != rhs.marks_[i]) {
                     return false;
                 }
             }
@@ -78,6 +89,7 @@ namespace nmbr9 {
         const int area_; ///< The area occupied by the tile
         const std::vector<Tile> alternatives_; ///< The tile alternatives (id, rot90, flip vertical, ...)
         const Gecode::REG placement_expression_; ///< A placement expression for placing on a 9x9 grid of Boolean variables with 1 eol column
+        const Gecode::DFA placement_automaton_; ///< The reified placement expression compiled to an automaton, shared by all copies
     public:
         /**
          *
@@ -97,11 +109,26 @@ namespace nmbr9 {
          */
         const Gecode::REG as_placement_expression() const;
 
+        /**
+         * The automaton is compiled once per tile and instance, and is shared between all copies of the tile and
+         * all levels.
+         *
+         * @return An automaton for the placement expression, preceded by a control variable that is 1 if the
+         *         tile is placed and 0 if the whole board is empty.
+         */
+        const Gecode::DFA& placement_automaton() const;
+
         const int id() const;
 
         const int value() const;
 
         const int area() const;
+
+        /**
+         *
+         * @return The unique rotations of the tile, the index of an alternative is its orientation
+         */
+        const std::vector<Tile>& alternatives() const;
     private:
         /**
          *
@@ -129,6 +156,14 @@ namespace nmbr9 {
          */
         static const Gecode::REG make_placement_expression(Instance instance, const std::vector<Tile>& alternatives);
 
+        /**
+         * Compile the placement expression reified with an additional first control variable.
+         *
+         * @param placement_expression The placement expression for the tile
+         * @return The automaton for the reified placement expression
+         */
+        static const Gecode::DFA make_placement_automaton(Instance instance, const Gecode::REG& placement_expression);
+
         static int pattern_square_value(char i1);
     };
 
@@ -184,6 +219,11 @@ namespace nmbr9 {
      */
     extern const std::vector<AbstractTileSource> base_tiles;
 
+    /**
+     * The number of tiles in base_tiles, tile ids are in 0..base_tile_count-1
+     */
+    constexpr int base_tile_count = 10;
+
     /**
      *
      * @return The number of unique tiles
@@ -212,11 +252,39 @@ namespace nmbr9 {
     const std::vector<int>& single_tiles();
 
     /**
+     * The returned reference stays valid for the lifetime of the program, so no copies need to be made.
+     * Safe to call concurrently from several threads.
      *
-     * @param tile The tile index to get. Must be between 0 and tile_count()
+     * @param tile The tile index to get. Must be between 1 and instance.number_of_parts()
      * @return The source for tile number \a tile
      */
-    TileSource tile(Instance instance, int tile);
+    const TileSource& tile(Instance instance, int tile);
+
+    /**
+     * Look up the value of a tile without going through its source.
+     *
+     * @param tile The tile index to get. Must be between 1 and instance.number_of_parts()
+     * @return The value of tile number \a tile
+     */
+    int tile_value(Instance instance, int tile);
+
+    /**
+     * Look up the area of a tile without going through its source.
+     *
+     * @param tile The tile index to get. Must be between 1 and instance.number_of_parts()
+     * @return The area occupied by tile number \a tile
+     */
+    int tile_area(Instance instance, int tile);
+
+    /**
+     * The footprints are computed once per instance, and are ordered by the distance to the center of the grid.
+     * Each footprint has its squares both as lists and as cache-aligned bitboards.
+     * The returned reference stays valid for the lifetime of the program and is safe to use from several threads.
+     *
+     * @param tile The tile index to get. Must be between 1 and instance.number_of_parts()
+     * @return All legal footprints of tile number \a tile on the grid of the instance
+     */
+    const FootprintTable& footprints(Instance instance, int tile);
 }
 
 #endif //NMBR9_TILES_H
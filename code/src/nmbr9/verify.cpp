@@ -0,0 +1,155 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include "verify.h"
+#include "tiles.h"
+
+#include <algorithm>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+namespace nmbr9 {
+
+    Verifier::Verifier(const Instance instance, const int max_layers)
+            : instance_(instance),
+              max_layers_(max_layers),
+              words_(bitboard::words_for(instance.wh() * instance.wh())),
+              footprints_(),
+              values_(),
+              occupied_(max_layers * words_ / bitboard::line_words),
+              marks_(),
+              used_(instance.number_of_parts(), 0) {
+        for (int p = 0; p < instance.number_of_parts(); ++p) {
+            footprints_.emplace_back(&nmbr9::footprints(instance, p + 1));
+            values_.emplace_back(nmbr9::tile_value(instance, p + 1));
+        }
+        marks_.reserve(instance.deck_size());
+    }
+
+    VerificationResult Verifier::verify(const Layout& layout) {
+        const auto failure = [](int card, const char* reason) {
+            return VerificationResult{false, 0, card, reason};
+        };
+
+        if (layout.size() != instance_.deck_size()) {
+            return failure(-1, "wrong number of cards");
+        }
+
+        for (auto& line : occupied_) {
+            bitboard::clear(line.words, bitboard::line_words);
+        }
+        std::fill(used_.begin(), used_.end(), 0);
+        marks_.clear();
+
+        int score = 0;
+        for (int card = 0; card < layout.size(); ++card) {
+            const Placement& placement = layout[card];
+            if (placement.part < 0 || placement.part >= instance_.number_of_parts()) {
+                return failure(card, "no such part");
+            }
+            if (used_[placement.part]) {
+                return failure(card, "part used twice");
+            }
+            used_[placement.part] = 1;
+            if (placement.level < 0 || placement.level >= max_layers_) {
+                return failure(card, "no such level");
+            }
+
+            // Footprints only exist for placements inside the border
+            const FootprintTable& footprints = *footprints_[placement.part];
+            const int index = footprints.find(placement.orientation, placement.x, placement.y);
+            if (index < 0) {
+                return failure(card, "not inside the border");
+            }
+            const Footprint& footprint = footprints[index];
+
+            const int lines = words_ / bitboard::line_words;
+            std::uint64_t* occupied = occupied_[placement.level * lines].words;
+            if (bitboard::intersects(footprint.mark_bits, occupied, words_)) {
+                return failure(card, "overlaps another part");
+            }
+            if (bitboard::popcount(occupied, words_) > 0
+                && !bitboard::intersects(footprint.around_bits, occupied, words_)) {
+                return failure(card, "not connected to an earlier part on the level");
+            }
+            if (placement.level > 0) {
+                const std::uint64_t* below = occupied_[(placement.level - 1) * lines].words;
+                if (!bitboard::subset(footprint.mark_bits, below, words_)) {
+                    return failure(card, "not fully supported by the level below");
+                }
+                int supporting_parts = 0;
+                for (int earlier = 0; earlier < card && supporting_parts < 2; ++earlier) {
+                    if (layout[earlier].level == placement.level - 1
+                        && bitboard::intersects(footprint.mark_bits, marks_[earlier], words_)) {
+                        ++supporting_parts;
+                    }
+                }
+                if (supporting_parts < 2) {
+                    return failure(card, "not resting on two different parts");
+                }
+            }
+
+            bitboard::add(occupied, footprint.mark_bits, words_);
+            marks_.emplace_back(footprint.mark_bits);
+            score += values_[placement.part] * placement.level;
+        }
+
+        return VerificationResult{true, score, -1, nullptr};
+    }
+
+    VerificationResult verify(const Instance instance, const int max_layers, const Layout& layout) {
+        Verifier verifier(instance, max_layers);
+        return verifier.verify(layout);
+    }
+
+    namespace {
+        /// Parse one placement, the whole token must be part:level:x:y:orientation
+        bool parse_placement(const std::string& token, Placement& placement) {
+            std::istringstream is(token);
+            char separator[4];
+            is >> placement.part >> separator[0] >> placement.level >> separator[1]
+               >> placement.x >> separator[2] >> placement.y >> separator[3] >> placement.orientation;
+            if (!is) {
+                return false;
+            }
+            for (char c : separator) {
+                if (c != ':') {
+                    return false;
+                }
+            }
+            return is.peek() == std::char_traits<char>::eof();
+        }
+    }
+
+    bool parse_layout(const std::string& line, Layout& layout) {
+        layout.clear();
+        std::istringstream tokens(line);
+        std::string token;
+        Placement placement{};
+        while (tokens >> token) {
+            if (!parse_placement(token, placement)) {
+                layout.clear();
+                return false;
+            }
+            layout.emplace_back(placement);
+        }
+        return true;
+    }
+
+    std::ostream& operator<<(std::ostream& os, const Placement& placement) {
+        return os << placement.part << ":" << placement.level << ":" << placement.x << ":" << placement.y
+                  << ":" << placement.orientation;
+    }
+
+    std::ostream& operator<<(std::ostream& os, const Layout& layout) {
+        for (int i = 0; i < layout.size(); ++i) {
+            if (i > 0) {
+                os << " ";
+            }
+            os << layout[i];
+        }
+        return os;
+    }
+}
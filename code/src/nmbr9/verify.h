@@ -0,0 +1,105 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#ifndef NMBR9_VERIFY_H
+#define NMBR9_VERIFY_H
+
+#include "base.h"
+#include "bitboard.h"
+#include "footprints.h"
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace nmbr9 {
+
+    /** \brief The placement of one card
+     *
+     * The position is given as for footprints, that is the upper left corner of the bounding box of the tile
+     * alternative including the squares around the tile.
+     */
+    struct Placement {
+        int part; ///< The part placed, 0 to number_of_parts-1
+        int level; ///< The level the part is placed on, 0 is the bottom level
+        int x; ///< The column of the upper left corner of the bounding box
+        int y; ///< The row of the upper left corner of the bounding box
+        int orientation; ///< The index of the tile alternative
+    };
+
+    /// The placements of all cards, in deck order
+    typedef std::vector<Placement> Layout;
+
+    /// The result of verifying a layout
+    struct VerificationResult {
+        bool legal; ///< True if the layout follows all the rules
+        int score; ///< The score of the layout, only valid if legal
+        int card; ///< The first card that breaks a rule, or -1
+        const char* reason; ///< Description of the rule broken, or nullptr
+    };
+
+    /** \brief Independent check of layouts
+     *
+     * A verifier checks that a layout follows the rules of the game for an instance, and computes the score. The
+     * check does not use the models, only the footprints of the tiles, and all tests on the boards are done on
+     * bitboards a full cache line at a time. The scratch boards are kept between calls, so verifying a layout
+     * does not allocate memory. A verifier may not be used from several threads at the same time.
+     */
+    class Verifier {
+        const Instance instance_;
+        const int max_layers_;
+        const int words_;
+        /// The footprints of each part
+        std::vector<const FootprintTable*> footprints_;
+        /// The value of each part
+        std::vector<int> values_;
+        /// The squares occupied on each level
+        std::vector<bitboard::Line> occupied_;
+        /// The covered squares of the cards placed so far
+        std::vector<const std::uint64_t*> marks_;
+        /// The part placed so far
+        std::vector<char> used_;
+    public:
+        Verifier(Instance instance, int max_layers);
+
+        /**
+         * Check that the layout places deck_size different parts, in deck order, so that no parts overlap, every
+         * part is inside the border, every part on a level except the first touches an earlier part on the same
+         * level, and every part above the bottom level rests fully on earlier parts, with at least two different
+         * parts below it.
+         *
+         * @param layout The placements of the cards, in deck order
+         * @return The result of the check, including the score if the layout is legal
+         */
+        VerificationResult verify(const Layout& layout);
+    };
+
+    /**
+     * Verify one layout, see Verifier::verify.
+     *
+     * @param instance The instance the layout is for
+     * @param max_layers The maximum number of levels
+     * @param layout The placements of the cards, in deck order
+     */
+    VerificationResult verify(Instance instance, int max_layers, const Layout& layout);
+
+    /**
+     * Parse a layout from one line of text, with placements separated by whitespace. Each placement is written
+     * as part:level:x:y:orientation.
+     *
+     * @param line The line to parse
+     * @param layout Set to the placements of the line, or cleared if the line can not be parsed
+     * @return False if some placement is not written as integers separated by ':', or if anything else is on
+     *         the line
+     */
+    bool parse_layout(const std::string& line, Layout& layout);
+
+    /// Write a placement as part:level:x:y:orientation
+    std::ostream& operator<<(std::ostream& os, const Placement& placement);
+
+    /// Write a layout in the format read by parse_layout
+    std::ostream& operator<<(std::ostream& os, const Layout& layout);
+}
+
+#endif //NMBR9_VERIFY_H
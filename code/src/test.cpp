@@ -0,0 +1,121 @@
+//
+// Created by Mikael Zayenz Lagerkvist
+//
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gecode/search.hh>
+
+#include "nmbr9/lib.h"
+#include "nmbr9/anchor.h"
+#include "nmbr9/batch.h"
+#include "nmbr9/verify.h"
+
+using namespace Gecode;
+
+namespace {
+
+    /// The instance from the paper
+    const char* const paper_instance = "-max-value 6 -copies 2 -deck-size 5 -grid-size 8 -max-layers 3";
+
+    int failures = 0;
+
+    void check(const bool condition, const std::string& what) {
+        if (!condition) {
+            std::cout << "FAILED " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    /// Lines that are not a list of placements are rejected as a whole
+    void test_parse_layout() {
+        nmbr9::Layout layout;
+        check(nmbr9::parse_layout("0:0:1:2:3 4:1:0:0:1", layout) && layout.size() == 2
+              && layout[1].part == 4 && layout[1].level == 1 && layout[1].orientation == 1,
+              "parse_layout of a full line");
+        check(!nmbr9::parse_layout("0:0:1:2:3 4:1:0:0", layout) && layout.empty(),
+              "parse_layout of a truncated line");
+        check(!nmbr9::parse_layout("0:0:1:2:3x", layout) && layout.empty(),
+              "parse_layout of a line with trailing text");
+        check(!nmbr9::parse_layout("0;0:1:2:3", layout) && layout.empty(),
+              "parse_layout of a line with a wrong separator");
+    }
+
+    /**
+     * Search for the best layout with branch and bound, and check each solution found by printing its layout,
+     * reading it back, and verifying it independently of the model.
+     *
+     * @return The best score, or -1 if there is none
+     */
+    template<class Model>
+    int solve_and_verify(const std::string& name, const nmbr9::Nmbr9Options& opt) {
+        auto* model = new Model(opt);
+        BAB<Model> engine(model);
+        delete model;
+
+        nmbr9::Verifier verifier(opt.instance(), opt.max_layers());
+        int best_score = -1;
+        while (Model* solution = engine.next()) {
+            best_score = solution->cost().val();
+
+            std::ostringstream printed;
+            printed << solution->layout();
+            nmbr9::Layout layout;
+            check(nmbr9::parse_layout(printed.str(), layout), name + ": reading the layout " + printed.str());
+            const nmbr9::VerificationResult result = verifier.verify(layout);
+            check(result.legal, name + ": legal layout " + printed.str()
+                                + (result.reason != nullptr ? std::string(", ") + result.reason : ""));
+            check(!result.legal || result.score == best_score,
+                  name + ": score of " + printed.str() + " is " + std::to_string(result.score)
+                  + ", the model says " + std::to_string(best_score));
+            delete solution;
+        }
+        std::cout << name << ": best score " << best_score << ", nodes " << engine.statistics().node << std::endl;
+        return best_score;
+    }
+}
+
+/**
+ * Solve the instance from the paper with each model, placement encoding, and the options that prune the search,
+ * verify all the solutions found, and check that all variants agree on the best score.
+ */
+int main() {
+    test_parse_layout();
+
+    // The first variant gives the expected score, it is the plain model without the score bound, so that options
+    // that prune, such as the bound, the symmetry breaking, and the branchings, are checked against it
+    const std::vector<std::string> variants{
+            "-score-bound false",
+            "-placement-encoding channel",
+            "-placement-encoding compact",
+            "-translation-symmetry true",
+            "-deck-level-symmetry true",
+            "-placement-branching footprint",
+            "-model anchor",
+    };
+    int expected = -1;
+    for (const std::string& variant : variants) {
+        nmbr9::Nmbr9Options opt;
+        std::string error;
+        if (!nmbr9::parse_options(std::string(paper_instance) + " " + variant, opt, error)) {
+            check(false, variant + ": " + error);
+            continue;
+        }
+        const int best = opt.model() == nmbr9::MT_ANCHOR
+                         ? solve_and_verify<nmbr9::Nmbr9AnchorBoard>(variant, opt)
+                         : solve_and_verify<nmbr9::Nmbr9Board>(variant, opt);
+        check(best >= 0, variant + ": no solution");
+        if (expected < 0) {
+            expected = best;
+        }
+        check(best == expected, variant + ": best score " + std::to_string(best) + ", expected "
+                                + std::to_string(expected));
+    }
+
+    std::cout << failures << " failures" << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}